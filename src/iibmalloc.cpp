@@ -35,10 +35,71 @@
 #include <nodecpp_assert.h>
 #include "iibmalloc.h"
 
+#ifdef NODECPP_MSVC
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
 namespace nodecpp::iibmalloc
 {
 	std::atomic<uint16_t> SafeIibAllocator::allocatorIDBase;
 
+#ifdef NODECPP_MSVC
+	void VirtualMemoryHints::discard( void* addr, size_t size )
+	{
+		void* ret = VirtualAlloc( addr, size, MEM_RESET, PAGE_READWRITE );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ret == addr );
+	}
+
+	void VirtualMemoryHints::protectNoAccess( void* addr, size_t size )
+	{
+		DWORD oldProtect;
+		BOOL ret = VirtualProtect( addr, size, PAGE_NOACCESS, &oldProtect );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ret );
+	}
+
+	void VirtualMemoryHints::protectReadWrite( void* addr, size_t size )
+	{
+		DWORD oldProtect;
+		BOOL ret = VirtualProtect( addr, size, PAGE_READWRITE, &oldProtect );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ret );
+	}
+
+	void* VirtualMemoryHints::remap( void* addr, size_t oldSize, size_t newSize )
+	{
+		return nullptr;
+	}
+#else
+	void VirtualMemoryHints::discard( void* addr, size_t size )
+	{
+		int ret = madvise( addr, size, MADV_DONTNEED );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ret == 0 );
+	}
+
+	void VirtualMemoryHints::protectNoAccess( void* addr, size_t size )
+	{
+		int ret = mprotect( addr, size, PROT_NONE );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ret == 0 );
+	}
+
+	void VirtualMemoryHints::protectReadWrite( void* addr, size_t size )
+	{
+		int ret = mprotect( addr, size, PROT_READ | PROT_WRITE );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ret == 0 );
+	}
+
+	void* VirtualMemoryHints::remap( void* addr, size_t oldSize, size_t newSize )
+	{
+#ifdef MREMAP_MAYMOVE
+		void* ret = mremap( addr, oldSize, newSize, MREMAP_MAYMOVE );
+		return ret != MAP_FAILED ? ret : nullptr;
+#else
+		return nullptr;
+#endif // MREMAP_MAYMOVE
+	}
+#endif // NODECPP_MSVC
+
 	thread_local ThreadLocalAllocatorT* g_CurrentAllocManager = nullptr;
 
 	ThreadLocalAllocatorT* setCurrneAllocator( ThreadLocalAllocatorT* allocator )
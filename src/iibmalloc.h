@@ -39,11 +39,8 @@
 #include "iibmalloc_common.h"
 #include "page_management.h"
 
-#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-#include <allocator_template.h>
-#include <malloc_based_allocator.h>
-#include <map>
-#endif
+#include <chrono>
+
 
 
 
@@ -168,6 +165,27 @@ class SoundingAddressPageAllocator : public BasePageAllocator
 	static constexpr size_t commit_size = (1 << (commit_page_cnt_exp + PAGE_SIZE_EXP));
 	static_assert( commit_page_cnt_exp <= reservation_size_exp - bucket_cnt_exp - PAGE_SIZE_EXP, "value mismatch" );
 
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+public:
+	// Slot generations: one counter per 8-byte granule of a block (all bucket sizes are at least 8), kept in a shadow area right after the block. 
+	// Blocks are aligned by reservation_size (so that a bucket index and a page within a bucket are just low bits of an address, see addressToIdx()), 
+	// and the shadow of a slot is found with no lookup; it is committed along with pages it describes
+	typedef uint8_t SlotGeneration;
+	static constexpr size_t generation_granule_exp = 3;
+	static constexpr size_t generation_shadow_size = reservation_size >> generation_granule_exp;
+	static_assert( commit_page_cnt_exp >= generation_granule_exp, "shadow of a commit range must be a whole number of pages" );
+	static constexpr size_t generation_reservation_size = reservation_size * 2 + generation_shadow_size; // enough to align a block and keep its shadow
+
+	static NODECPP_FORCEINLINE SlotGeneration* slotGenerationAddress( void* ptr )
+	{
+		uintptr_t offsetInBlock = (uintptr_t)(ptr) & ( reservation_size - 1 );
+		uintptr_t blockStart = (uintptr_t)(ptr) - offsetInBlock;
+		return reinterpret_cast<SlotGeneration*>( blockStart + reservation_size + ( offsetInBlock >> generation_granule_exp ) );
+	}
+
+private:
+#endif // NODECPP_USE_SLOT_GENERATIONS
+
 	struct MemoryBlockHeader
 	{
 		MemoryBlockListItem block;
@@ -178,6 +196,9 @@ class SoundingAddressPageAllocator : public BasePageAllocator
 	{
 		PageBlockDescriptor* next = nullptr;
 		void* blockAddress = nullptr;
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+		void* reservationAddress = nullptr; // of generation_reservation_size bytes; blockAddress is aligned within it
+#endif // NODECPP_USE_SLOT_GENERATIONS
 		uint16_t nextToUse[ bucket_cnt ];
 		uint16_t nextToCommit[ bucket_cnt ];
 		static_assert( UINT16_MAX > pages_per_bucket , "revise implementation" );
@@ -198,7 +219,12 @@ class SoundingAddressPageAllocator : public BasePageAllocator
 		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, reasonIdx < bucket_cnt );
 //		PageBlockDescriptor* pb = new PageBlockDescriptor; // TODO: consider using our own allocator
 		PageBlockDescriptor* pb = pageBlockDescriptors.createNew();
+#ifndef NODECPP_USE_SLOT_GENERATIONS
 		pb->blockAddress = getNextBlock();
+#else
+		pb->reservationAddress = this->AllocateAddressSpace( generation_reservation_size );
+		pb->blockAddress = reinterpret_cast<void*>( alignUpExp( (uintptr_t)(pb->reservationAddress), reservation_size_exp ) );
+#endif // NODECPP_USE_SLOT_GENERATIONS
 //nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::iibmalloc_module_id), "createNextBlockAndGetPage(): descriptor allocated at 0x{:x}; block = 0x{:x}", (size_t)(pb), (size_t)(pb->blockAddress) );
 		memset( pb->nextToUse, 0, sizeof( uint16_t) * bucket_cnt );
 		memset( pb->nextToCommit, 0, sizeof( uint16_t) * bucket_cnt );
@@ -301,6 +327,11 @@ public:
 			}
 		}
 		this->CommitMemory( start, prevNext - start + PAGE_SIZE_BYTES );
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+		// in an aligned block, pages of a bucket never wrap around (see idxToPageAddr()), thus a range is contiguous, and so is its shadow
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ( pageIdx & ( ( 1 << generation_granule_exp ) - 1 ) ) == 0 );
+		this->CommitMemory( slotGenerationAddress( idxToPageAddr( blockptr, bucketIdx, pageIdx ) ), ( rangeSize << PAGE_SIZE_EXP ) >> generation_granule_exp );
+#endif // NODECPP_USE_SLOT_GENERATIONS
 	}
 
 	void* getPage( size_t idx )
@@ -404,6 +435,21 @@ public:
 		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, mpData.sz1 + mpData.sz2 == ( multipage_page_cnt << PAGE_SIZE_EXP ) );
 	}
 
+	static size_t committedSizeInBlock( const PageBlockDescriptor* pb )
+	{
+		size_t pageCnt = 0;
+		for ( size_t i=0; i<bucket_cnt; ++i )
+			pageCnt += pb->nextToCommit[i];
+#ifndef NODECPP_USE_SLOT_GENERATIONS
+		return pageCnt << PAGE_SIZE_EXP;
+#else
+		return ( pageCnt << PAGE_SIZE_EXP ) + ( ( pageCnt << PAGE_SIZE_EXP ) >> generation_granule_exp );
+#endif // NODECPP_USE_SLOT_GENERATIONS
+	}
+
+	// including memory occupied by block descriptors
+	size_t getCommittedSize() const { return this->getStats().getCommittedSize() + pageBlockDescriptors.getStats().getCommittedSize(); }
+
 	void freePage( MemoryBlockListItem* chk )
 	{
 		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, false );
@@ -417,7 +463,11 @@ public:
 		{
 //nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::iibmalloc_module_id), "in block 0x{:x} about to delete 0x{:x} of size 0x{:x}", (size_t)( next ), (size_t)( next->blockAddress ), PAGE_SIZE_BYTES * bucket_cnt );
 			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, next->blockAddress );
-			this->freeChunkNoCache( reinterpret_cast<MemoryBlockListItem*>( next->blockAddress ), reservation_size );
+#ifndef NODECPP_USE_SLOT_GENERATIONS
+			this->freeChunkNoCache( reinterpret_cast<MemoryBlockListItem*>( next->blockAddress ), reservation_size, committedSizeInBlock( next ) );
+#else
+			this->freeChunkNoCache( next->reservationAddress, generation_reservation_size, committedSizeInBlock( next ) );
+#endif // NODECPP_USE_SLOT_GENERATIONS
 			PageBlockDescriptor* tmp = next->next;
 //			delete next;
 			next = tmp;
@@ -433,6 +483,21 @@ public:
 
 //#define BULKALLOCATOR_HEAVY_DEBUG
 
+struct HugeChunkCacheStats
+{
+	uint64_t hitCount = 0;
+	uint64_t missCount = 0; // while the cache is enabled
+	uint64_t cachedSize = 0;
+	uint64_t peakCachedSize = 0;
+	uint64_t evictedSize = 0; // released to stay within the limit
+	uint64_t decayedSize = 0; // released as not reused in time
+
+	void printStats() const
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::iibmalloc_module_id), "Huge chunk cache {} (peak {}), hits {}, misses {}, evicted {}, decayed {}\n", cachedSize, peakCachedSize, hitCount, missCount, evictedSize, decayedSize );
+	}
+};
+
 template<class BasePageAllocator, size_t commited_block_size, uint16_t max_pages>
 class BulkAllocator : public BasePageAllocator
 {
@@ -468,16 +533,207 @@ public:
 	constexpr size_t maxAllocatableSize() {return ((size_t)max_pages) << PAGE_SIZE_EXP; }
 	static constexpr size_t reservedSizeAtPageStart() { return std::max( sizeof( AnyChunkHeader ), (size_t)(NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT) ); }
 
+	static constexpr size_t default_huge_chunk_cache_limit = 32 * 1024 * 1024;
+	static constexpr uint64_t default_huge_chunk_cache_decay_ms = 1000;
+	static constexpr size_t default_huge_chunk_cache_slack_percent = 25;
+
 private:
 //	std::vector<AnyChunkHeader*> blockList;
 	CollectionInPages<BasePageAllocator,AnyChunkHeader*> blocks;
 
+	// Huge chunks (of more than max_pages pages) are mapped one by one; when deallocated, they are retained (still mapped) for reuse, 
+	// binned by the highest bit of their page count, and also listed from the newest to the oldest for eviction and decay
+	struct CachedHugeChunk
+	{
+		AnyChunkHeader header;
+		size_t size;
+		uint64_t cachedAt; // ms, see hugeChunkCacheNow()
+		CachedHugeChunk* prevInBin;
+		CachedHugeChunk* nextInBin;
+		CachedHugeChunk* newer;
+		CachedHugeChunk* older;
+	};
+	static constexpr size_t huge_chunk_bin_count = 64;
+	CachedHugeChunk* hugeChunkBins[ huge_chunk_bin_count ];
+	CachedHugeChunk* newestCachedHugeChunk;
+	CachedHugeChunk* oldestCachedHugeChunk;
+	size_t hugeChunkCacheLimit; // 0 to disable caching
+	uint64_t hugeChunkCacheDecayMs;
+	size_t hugeChunkCacheSlackPercent;
+	HugeChunkCacheStats hugeChunkCacheStats;
+
+	static uint64_t hugeChunkCacheNow() { return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count(); }
+	static NODECPP_FORCEINLINE size_t hugeChunkBinIdx( size_t size ) { return highestSetBit( size >> PAGE_SIZE_EXP ); }
+
+	void unlinkCachedHugeChunk( CachedHugeChunk* chunk )
+	{
+		if ( chunk->prevInBin != nullptr )
+			chunk->prevInBin->nextInBin = chunk->nextInBin;
+		else
+			hugeChunkBins[ hugeChunkBinIdx( chunk->size ) ] = chunk->nextInBin;
+		if ( chunk->nextInBin != nullptr )
+			chunk->nextInBin->prevInBin = chunk->prevInBin;
+		if ( chunk->newer != nullptr )
+			chunk->newer->older = chunk->older;
+		else
+			newestCachedHugeChunk = chunk->older;
+		if ( chunk->older != nullptr )
+			chunk->older->newer = chunk->newer;
+		else
+			oldestCachedHugeChunk = chunk->newer;
+		hugeChunkCacheStats.cachedSize -= chunk->size;
+	}
+
+	void releaseCachedHugeChunk( CachedHugeChunk* chunk )
+	{
+		size_t size = chunk->size;
+		unlinkCachedHugeChunk( chunk );
+		this->freeChunkNoCache( chunk, size );
+	}
+
+	// the smallest cached chunk of at least 'size' bytes, but not more than the slack allows
+	CachedHugeChunk* findCachedHugeChunk( size_t size )
+	{
+		size_t maxSize = size + size / 100 * hugeChunkCacheSlackPercent;
+		size_t maxBinIdx = hugeChunkBinIdx( maxSize );
+		for ( size_t binIdx = hugeChunkBinIdx( size ); binIdx <= maxBinIdx; ++binIdx )
+		{
+			CachedHugeChunk* best = nullptr;
+			for ( CachedHugeChunk* curr = hugeChunkBins[binIdx]; curr != nullptr; curr = curr->nextInBin )
+				if ( curr->size >= size && curr->size <= maxSize && ( best == nullptr || curr->size < best->size ) )
+					best = curr;
+			if ( best != nullptr ) // chunks of further bins are larger
+				return best;
+		}
+		return nullptr;
+	}
+
+	void releaseDecayedHugeChunks( uint64_t now )
+	{
+		while ( oldestCachedHugeChunk != nullptr && now - oldestCachedHugeChunk->cachedAt >= hugeChunkCacheDecayMs )
+		{
+			hugeChunkCacheStats.decayedSize += oldestCachedHugeChunk->size;
+			releaseCachedHugeChunk( oldestCachedHugeChunk );
+		}
+	}
+
+	void evictHugeChunksAbove( size_t limit )
+	{
+		while ( hugeChunkCacheStats.cachedSize > limit )
+		{
+			hugeChunkCacheStats.evictedSize += oldestCachedHugeChunk->size;
+			releaseCachedHugeChunk( oldestCachedHugeChunk );
+		}
+	}
+
+	AnyChunkHeader* allocateHugeChunk( size_t size )
+	{
+		if ( hugeChunkCacheLimit != 0 )
+		{
+			if ( newestCachedHugeChunk != nullptr )
+			{
+				releaseDecayedHugeChunks( hugeChunkCacheNow() );
+				CachedHugeChunk* chunk = findCachedHugeChunk( size );
+				if ( chunk != nullptr )
+				{
+					++(hugeChunkCacheStats.hitCount);
+					size = chunk->size;
+					unlinkCachedHugeChunk( chunk );
+					AnyChunkHeader* ret = &(chunk->header);
+					ret->set( (AnyChunkHeader*)(void*)(size), nullptr, 0, false );
+					return ret;
+				}
+			}
+			++(hugeChunkCacheStats.missCount);
+		}
+		AnyChunkHeader* ret = reinterpret_cast<AnyChunkHeader*>( this->getFreeBlockNoCache( size ) );
+		ret->set( (AnyChunkHeader*)(void*)(size), nullptr, 0, false );
+		return ret;
+	}
+
+	void deallocateHugeChunk( void* ptr, size_t size )
+	{
+		if ( size > hugeChunkCacheLimit )
+		{
+			this->freeChunkNoCache( ptr, size );
+			return;
+		}
+		uint64_t now = hugeChunkCacheNow();
+		releaseDecayedHugeChunks( now );
+		evictHugeChunksAbove( hugeChunkCacheLimit - size );
+		CachedHugeChunk* chunk = reinterpret_cast<CachedHugeChunk*>( ptr );
+		chunk->size = size;
+		chunk->cachedAt = now;
+		size_t binIdx = hugeChunkBinIdx( size );
+		chunk->prevInBin = nullptr;
+		chunk->nextInBin = hugeChunkBins[binIdx];
+		if ( hugeChunkBins[binIdx] != nullptr )
+			hugeChunkBins[binIdx]->prevInBin = chunk;
+		hugeChunkBins[binIdx] = chunk;
+		chunk->newer = nullptr;
+		chunk->older = newestCachedHugeChunk;
+		if ( newestCachedHugeChunk != nullptr )
+			newestCachedHugeChunk->newer = chunk;
+		else
+			oldestCachedHugeChunk = chunk;
+		newestCachedHugeChunk = chunk;
+		hugeChunkCacheStats.cachedSize += size;
+		if ( hugeChunkCacheStats.cachedSize > hugeChunkCacheStats.peakCachedSize )
+			hugeChunkCacheStats.peakCachedSize = hugeChunkCacheStats.cachedSize;
+	}
+
 	struct FreeChunkHeader : public AnyChunkHeader
 	{
 		FreeChunkHeader* prevFree;
 		FreeChunkHeader* nextFree;
 	};
+	// [i] is for free chunks of i + 1 pages; [max_pages] is for larger ones, sorted by size (then by address), so that the first one is the best fit
 	FreeChunkHeader* freeListBegin[ max_pages + 1 ];
+	uint64_t nonEmptyFreeLists; // bit i is set iff freeListBegin[i] != nullptr
+	static_assert( max_pages < 64, "revise implementation" );
+
+	static NODECPP_FORCEINLINE size_t freeListIdx( size_t pageCount ) { return pageCount <= max_pages ? pageCount - 1 : max_pages; }
+
+	void addToFreeList( FreeChunkHeader* item )
+	{
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, item->isFree() );
+		size_t idx = freeListIdx( item->getPageCount() );
+		FreeChunkHeader* prev = nullptr;
+		FreeChunkHeader* next = freeListBegin[idx];
+		if ( idx == max_pages )
+			while ( next != nullptr && ( next->getPageCount() < item->getPageCount() || ( next->getPageCount() == item->getPageCount() && next < item ) ) )
+			{
+				prev = next;
+				next = next->nextFree;
+			}
+		item->prevFree = prev;
+		item->nextFree = next;
+		if ( prev != nullptr )
+			prev->nextFree = item;
+		else
+			freeListBegin[idx] = item;
+		if ( next != nullptr )
+			next->prevFree = item;
+		nonEmptyFreeLists |= ((uint64_t)1) << idx;
+	}
+
+	// turns a free chunk (already removed from its free list) into an allocated chunk of 'pageCount' pages; the rest of it, if any, is returned to free lists
+	AnyChunkHeader* splitFreeChunk( FreeChunkHeader* chunk, size_t pageCount )
+	{
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, chunk->getPageCount() >= pageCount );
+		AnyChunkHeader* next = chunk->nextInBlock();
+		if ( chunk->getPageCount() > pageCount )
+		{
+			FreeChunkHeader* rest = reinterpret_cast<FreeChunkHeader*>( reinterpret_cast<uint8_t*>(chunk) + (pageCount << PAGE_SIZE_EXP) );
+			rest->set( chunk, next, chunk->getPageCount() - (uint16_t)pageCount, true );
+			if ( next != nullptr )
+				next->setPrevInBlock( rest );
+			next = rest;
+			addToFreeList( rest );
+		}
+		chunk->set( chunk->prevInBlock(), next, (uint16_t)pageCount, false );
+		return chunk;
+	}
 
 	void removeFromFreeList( FreeChunkHeader* item )
 	{
@@ -495,6 +751,8 @@ private:
 			freeListBegin[idx] = item->nextFree;
 			if ( freeListBegin[idx] != nullptr )
 				freeListBegin[idx]->prevFree = nullptr;
+			else
+				nonEmptyFreeLists &= ~(((uint64_t)1) << idx);
 		}
 		if ( item->nextFree )
 		{
@@ -562,6 +820,7 @@ private:
 			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, curr->isFree() );
 			const FreeChunkHeader* next = curr->nextFree;
 			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, next == nullptr || next->prevFree == curr );
+			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, next == nullptr || next->getPageCount() >= curr->getPageCount() );
 			curr = next;
 		}
 		curr = h;
@@ -580,6 +839,7 @@ private:
 		for ( uint16_t i=0; i<=max_pages; ++i )
 		{
 			FreeChunkHeader* h = freeListBegin[i];
+			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ( ( nonEmptyFreeLists >> i ) & 1 ) == ( h != nullptr ) );
 			if ( h !=nullptr )
 				dbgValidateFreeList( h, i + 1 );
 		}
@@ -591,6 +851,15 @@ public:
 		BasePageAllocator::initialize( blockSizeExp );
 		for ( size_t i=0; i<=max_pages; ++i )
 			freeListBegin[i] = nullptr;
+		nonEmptyFreeLists = 0;
+		for ( size_t i=0; i<huge_chunk_bin_count; ++i )
+			hugeChunkBins[i] = nullptr;
+		newestCachedHugeChunk = nullptr;
+		oldestCachedHugeChunk = nullptr;
+		hugeChunkCacheLimit = default_huge_chunk_cache_limit;
+		hugeChunkCacheDecayMs = default_huge_chunk_cache_decay_ms;
+		hugeChunkCacheSlackPercent = default_huge_chunk_cache_slack_percent;
+		hugeChunkCacheStats = HugeChunkCacheStats();
 //		new ( &blockList ) std::vector<AnyChunkHeader*>;
 		blocks.initialize( PAGE_SIZE_EXP );
 #ifdef BULKALLOCATOR_HEAVY_DEBUG
@@ -615,67 +884,27 @@ public:
 			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, pageCount <= UINT16_MAX );
 			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, pageCount <= max_pages );
 
-			if ( freeListBegin[pageCount - 1] == nullptr )
+			// the smallest chunk that fits (for the list of larger chunks, it is the first one)
+			uint64_t fitting = nonEmptyFreeLists & ( ~((uint64_t)0) << ( pageCount - 1 ) );
+			if ( fitting == 0 ) // UNLIKELY
 			{
-				if ( freeListBegin[ max_pages ] == nullptr )
-				{
-					FreeChunkHeader* h = reinterpret_cast<FreeChunkHeader*>( this->getFreeBlockNoCache( commited_block_size ) );
-					NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, h!= nullptr );
-//					blockList.push_back( h );
-					*(blocks.createNew()) = h;
-					freeListBegin[ max_pages ] = h;
-					freeListBegin[ max_pages ]->set( nullptr, nullptr, pagesPerAllocatedBlock, true );
-					freeListBegin[ max_pages ]->nextFree = nullptr;
-					freeListBegin[ max_pages ]->prevFree = nullptr;
-				}
-
-				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, freeListBegin[ max_pages ] != nullptr );
-				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, freeListBegin[ max_pages ]->getPageCount() > max_pages );
-				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, freeListBegin[ max_pages ]->prevFree == nullptr );
-
-				ret = freeListBegin[ max_pages ];
-				freeListBegin[ max_pages ] = freeListBegin[ max_pages ]->nextFree; // pop
-				if ( freeListBegin[ max_pages ] != nullptr )
-					freeListBegin[ max_pages ]->prevFree = nullptr;
-				FreeChunkHeader* updatedBegin = reinterpret_cast<FreeChunkHeader*>( reinterpret_cast<uint8_t*>(ret) + (pageCount << PAGE_SIZE_EXP) );
-				updatedBegin->set( ret, ret->nextInBlock(), ret->getPageCount() - (uint16_t)pageCount, true );
-				updatedBegin->prevFree = nullptr;
-				updatedBegin->nextFree = nullptr;
-
-				ret->set( ret->prevInBlock(), updatedBegin, (uint16_t)pageCount, false );
-				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, freeListBegin[ max_pages ] != updatedBegin );
-
-				uint16_t remainingPageCnt = updatedBegin->getPageCount();
-				if ( remainingPageCnt > max_pages )
-				{
-					updatedBegin->nextFree = freeListBegin[ max_pages ];
-					if ( freeListBegin[ max_pages ] != nullptr )
-						freeListBegin[ max_pages ]->prevFree = updatedBegin;
-					freeListBegin[ max_pages ] = updatedBegin;
-				}
-				else
-				{
-					updatedBegin->nextFree = freeListBegin[ remainingPageCnt - 1 ];
-					if ( freeListBegin[ remainingPageCnt - 1 ] != nullptr )
-						freeListBegin[ remainingPageCnt - 1 ]->prevFree = updatedBegin;
-					freeListBegin[ remainingPageCnt - 1 ] = updatedBegin;
-				}
-			}
-			else
-			{
-				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, freeListBegin[pageCount - 1]->nextFree == nullptr || freeListBegin[pageCount - 1]->nextFree->prevFree == freeListBegin[pageCount - 1] );
-				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, freeListBegin[pageCount - 1]->prevFree == nullptr );
-				ret = freeListBegin[pageCount - 1];
-				freeListBegin[pageCount - 1] = freeListBegin[pageCount - 1]->nextFree;
-				if ( freeListBegin[pageCount - 1] != nullptr )
-					freeListBegin[pageCount - 1]->prevFree = nullptr;
+				FreeChunkHeader* h = reinterpret_cast<FreeChunkHeader*>( this->getFreeBlockNoCache( commited_block_size ) );
+				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, h!= nullptr );
+//				blockList.push_back( h );
+				*(blocks.createNew()) = h;
+				h->set( nullptr, nullptr, pagesPerAllocatedBlock, true );
+				addToFreeList( h );
+				fitting = ((uint64_t)1) << max_pages;
 			}
+			FreeChunkHeader* chunk = freeListBegin[ lowestSetBit( fitting ) ];
+			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, chunk != nullptr && chunk->prevFree == nullptr );
+			removeFromFreeList( chunk );
+			ret = splitFreeChunk( chunk, pageCount );
 			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ret->getPageCount() <= max_pages );
 		}
 		else
 		{
-			ret = reinterpret_cast<FreeChunkHeader*>( this->getFreeBlockNoCache( pageCount << PAGE_SIZE_EXP ) );
-			ret->set( (FreeChunkHeader*)(void*)(pageCount<<PAGE_SIZE_EXP), nullptr, 0, false );
+			ret = allocateHugeChunk( pageCount << PAGE_SIZE_EXP );
 			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ret->getPageCount() == 0 );
 		}
 
@@ -704,9 +933,11 @@ public:
 			{
 				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, prev->prevInBlock() == nullptr || !prev->prevInBlock()->isFree() );
 				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, prev->nextInBlock() == h );
-				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, reinterpret_cast<uint8_t*>(prev->prevInBlock()) + (prev->prevInBlock()->getPageCount() << PAGE_SIZE_EXP) == reinterpret_cast<uint8_t*>( h ) );
+				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, reinterpret_cast<uint8_t*>(prev) + (prev->getPageCount() << PAGE_SIZE_EXP) == reinterpret_cast<uint8_t*>( h ) );
 				removeFromFreeList( static_cast<FreeChunkHeader*>(prev) );
 				prev->set( prev->prevInBlock(), h->nextInBlock(), prev->getPageCount() + h->getPageCount(), true );
+				if ( prev->nextInBlock() != nullptr )
+					prev->nextInBlock()->setPrevInBlock( prev );
 				h = prev;
 			}
 			AnyChunkHeader* next = h->nextInBlock();
@@ -717,17 +948,13 @@ public:
 				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, reinterpret_cast<uint8_t*>(h) + (h->getPageCount() << PAGE_SIZE_EXP) == reinterpret_cast<uint8_t*>( next ) );
 				removeFromFreeList( static_cast<FreeChunkHeader*>(next) );
 				h->set( h->prevInBlock(), next->nextInBlock(), h->getPageCount() + next->getPageCount(), true );
+				if ( h->nextInBlock() != nullptr )
+					h->nextInBlock()->setPrevInBlock( h );
 			}
 
-			FreeChunkHeader* hfree = static_cast<FreeChunkHeader*>(h);
-			uint16_t idx = hfree->getPageCount() - 1;
-			if ( idx >= max_pages )
-				idx = max_pages;
-			hfree->prevFree = nullptr;
-			hfree->nextFree = freeListBegin[idx];
-			if ( freeListBegin[idx] != nullptr )
-				freeListBegin[idx]->prevFree = hfree;
-			freeListBegin[idx] = hfree;
+			if ( !h->isFree() )
+				h->set( h->prevInBlock(), h->nextInBlock(), h->getPageCount(), true );
+			addToFreeList( static_cast<FreeChunkHeader*>(h) );
 
 #ifdef BULKALLOCATOR_HEAVY_DEBUG
 		dbgValidateAllBlocks();
@@ -737,7 +964,7 @@ public:
 		else
 		{
 			size_t deallocSize = (size_t)(h->prevInBlock());
-			this->freeChunkNoCache( ptr, deallocSize );
+			deallocateHugeChunk( ptr, deallocSize );
 		}
 
 	}
@@ -757,8 +984,51 @@ public:
 
 	}
 
+	// A huge chunk is resized in place or moved by remapping its pages, without copying; 'newSzIncludingHeader' must also be above maxAllocatableSize(). 
+	// Returns nullptr if the OS cannot remap it (then the chunk is left intact)
+	AnyChunkHeader* reallocateHugeChunk( void* ptr, size_t newSzIncludingHeader )
+	{
+		AnyChunkHeader* h = reinterpret_cast<AnyChunkHeader*>( ptr );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, h->getPageCount() == 0 );
+		size_t size = (size_t)(h->prevInBlock());
+		size_t newSize = alignUpExp( newSzIncludingHeader, PAGE_SIZE_EXP );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, newSize > maxAllocatableSize() );
+		if ( newSize == size )
+			return h;
+		AnyChunkHeader* ret = reinterpret_cast<AnyChunkHeader*>( this->remapChunkNoCache( ptr, size, newSize ) );
+		if ( ret != nullptr )
+			ret->set( (AnyChunkHeader*)(void*)(newSize), nullptr, 0, false );
+		return ret;
+	}
+
+	// including memory occupied by the list of blocks
+	size_t getCommittedSize() const { return this->getStats().getCommittedSize() + blocks.getStats().getCommittedSize(); }
+
+	// Deallocated huge chunks are kept mapped, up to 'limit' bytes in total (0 disables caching), and are released if not reused within 'decayMs'. 
+	// A cached chunk is reused for a request that is smaller by at most 'slackPercent' percent
+	void setHugeChunkCacheLimits( size_t limit, uint64_t decayMs = default_huge_chunk_cache_decay_ms, size_t slackPercent = default_huge_chunk_cache_slack_percent )
+	{
+		hugeChunkCacheLimit = limit;
+		hugeChunkCacheDecayMs = decayMs;
+		hugeChunkCacheSlackPercent = slackPercent;
+		evictHugeChunksAbove( limit );
+	}
+
+	// releases cached huge chunks that have decayed (or all of them)
+	void releaseHugeChunkCache( bool all = false )
+	{
+		if ( all )
+			evictHugeChunksAbove( 0 );
+		else
+			releaseDecayedHugeChunks( hugeChunkCacheNow() );
+	}
+
+	HugeChunkCacheStats getHugeChunkCacheStats() const { return hugeChunkCacheStats; }
+
 	void deinitialize()
 	{
+		while ( oldestCachedHugeChunk != nullptr )
+			releaseCachedHugeChunk( oldestCachedHugeChunk );
 		class F { private: BasePageAllocator* alloc; public: F(BasePageAllocator*alloc_) {alloc = alloc_;} void f(AnyChunkHeader* h) {NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, h != nullptr ); alloc->freeChunkNoCache( h, commited_block_size ); } }; F f(this);
 		blocks.doForEach(f);
 		blocks.deinitialize();
@@ -770,6 +1040,7 @@ public:
 		blockList.clear();*/
 		for ( size_t i=0; i<=max_pages; ++i )
 			freeListBegin[i] = nullptr;
+		nonEmptyFreeLists = 0;
 #ifdef BULKALLOCATOR_HEAVY_DEBUG
 		dbgValidateAllBlocks();
 		dbgValidateAllFreeLists();
@@ -796,6 +1067,8 @@ protected:
 	typedef SoundingAddressPageAllocator<PageAllocatorWithCaching, BucketCountExp, reservation_size_exp, 4, 3> PageAllocatorT;
 	PageAllocatorT pageAllocator;
 
+	size_t slowPathCount = 0; // calls that went beyond popping/pushing a bucket (for diagnostic purposes)
+
 public:
 #ifdef USE_EXP_BUCKET_SIZES
 	static constexpr
@@ -1068,6 +1341,7 @@ public:
 #error Undefined bucket size schema
 #endif
 		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, bucketSz >= sizeof( void* ) );
+		++slowPathCount;
 		PageAllocatorT::MultipageData mpData;
 //		uint8_t* block = reinterpret_cast<uint8_t*>( pageAllocator.getPage( szidx ) );
 		pageAllocator.getMultipage( szidx, mpData );
@@ -1081,6 +1355,7 @@ public:
 	NODECPP_NOINLINE void* allocateInCaseTooLargeForBucket(size_t sz)
 	{
 		constexpr size_t memStart = alignUpExp( BulkAllocatorT::reservedSizeAtPageStart(), ALIGNMENT_EXP );
+		++slowPathCount;
 		void* block = bulkAllocator.allocate( sz + memStart );
 
 		return reinterpret_cast<uint8_t*>(block) + memStart;
@@ -1220,12 +1495,47 @@ public:
 			}
 			else
 			{
+				++slowPathCount;
 				void* pageStart = PageAllocatorT::ptrToPageStart( ptr );
 				bulkAllocator.deallocate( pageStart );
 			}
 		}
 	}
 
+	// Huge chunks stay huge by remapping their pages where the OS supports that (no data is copied). Otherwise, a chunk is kept 
+	// if the new size fits and is at least half of the current one; if not, a new chunk is allocated and the data is copied
+	NODECPP_NOINLINE void* reallocate(void* ptr, size_t sz)
+	{
+		if ( ptr == nullptr )
+			return allocate( sz );
+
+		size_t usableSize;
+		size_t offsetInPage = PageAllocatorT::getOffsetInPage( ptr );
+		constexpr size_t memForbidden = alignUpExp( BulkAllocatorT::reservedSizeAtPageStart(), ALIGNMENT_EXP );
+		if ( offsetInPage != memForbidden )
+			usableSize = getAllocatedSize( ptr );
+		else
+		{
+			void* pageStart = PageAllocatorT::ptrToPageStart( ptr );
+			size_t chunkSize = bulkAllocator.getAllocatedSize( pageStart );
+			if ( chunkSize > bulkAllocator.maxAllocatableSize() && sz + memForbidden > bulkAllocator.maxAllocatableSize() )
+			{
+				++slowPathCount;
+				void* block = bulkAllocator.reallocateHugeChunk( pageStart, sz + memForbidden );
+				if ( block != nullptr ) // LIKELY
+					return reinterpret_cast<uint8_t*>(block) + memForbidden;
+			}
+			usableSize = chunkSize - memForbidden;
+		}
+
+		if ( sz <= usableSize && sz >= usableSize / 2 )
+			return ptr;
+		void* ret = allocate( sz );
+		memcpy( ret, ptr, sz < usableSize ? sz : usableSize );
+		deallocate( ptr );
+		return ret;
+	}
+
 	NODECPP_FORCEINLINE size_t getAllocatedSize(void* ptr)
 	{
 		if(ptr)
@@ -1256,10 +1566,18 @@ public:
 	}
 	
 	const BlockStats& getStats() const { return pageAllocator.getStats(); }
+	size_t getCommittedSize() const { return pageAllocator.getCommittedSize() + bulkAllocator.getCommittedSize(); }
+	size_t getSlowPathCount() const { return slowPathCount; }
+
+	// see BulkAllocator::setHugeChunkCacheLimits()
+	void setHugeChunkCacheLimits( size_t limit, uint64_t decayMs = BulkAllocatorT::default_huge_chunk_cache_decay_ms, size_t slackPercent = BulkAllocatorT::default_huge_chunk_cache_slack_percent ) { bulkAllocator.setHugeChunkCacheLimits( limit, decayMs, slackPercent ); }
+	void releaseHugeChunkCache( bool all = false ) { bulkAllocator.releaseHugeChunkCache( all ); }
+	HugeChunkCacheStats getHugeChunkCacheStats() const { return bulkAllocator.getHugeChunkCacheStats(); }
 	
 	void printStats() const 
 	{
 		pageAllocator.printStats();
+		bulkAllocator.getHugeChunkCacheStats().printStats();
 	}
 
 	void initialize(size_t size)
@@ -1270,6 +1588,7 @@ public:
 	void initialize()
 	{
 		memset( buckets, 0, sizeof( void* ) * BucketCount );
+		slowPathCount = 0;
 		pageAllocator.initialize( PAGE_SIZE_EXP );
 		bulkAllocator.initialize( PAGE_SIZE_EXP );
 	}
@@ -1328,53 +1647,542 @@ extern thread_local ThreadLocalAllocatorT* g_CurrentAllocManager;
 
 #include <atomic>
 
+#ifndef NODECPP_DISABLE_ZOMBIE_PREFIX
 constexpr size_t guaranteed_prefix_size = 8;
+#else
+// zombie lists are kept out of band (see ZombieList below), and zombieableAllocate() adds nothing to a requested size
+constexpr size_t guaranteed_prefix_size = 0;
+#endif // NODECPP_DISABLE_ZOMBIE_PREFIX
+
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+// Zombie (deallocated but not yet killed) memory, at 8-byte granularity (all block starts and sizes are multiples of 8):
+// a radix map from address to per-page bitmaps, with leaves covering reservation-size regions (as in SoundingAddressPageAllocator).
+// Each page bitmap is tagged with an epoch, and bitmaps of other epochs are considered empty; thus 
+// marking and lookups are O(1) per page and never allocate (except for the first use of a region), and clear() is O(1).
+template<class BasePageAllocator, size_t leaf_size_exp>
+class ZombiePageMap : public BasePageAllocator
+{
+	static constexpr size_t granule_exp = 3;
+	static constexpr size_t words_per_page = ( PAGE_SIZE_BYTES >> granule_exp ) / 64;
+	static constexpr size_t address_bits = 48;
+	static constexpr size_t leaf_page_cnt_exp = leaf_size_exp - PAGE_SIZE_EXP;
+	static constexpr size_t mid_cnt_exp = 12;
+	static constexpr size_t top_cnt_exp = address_bits - leaf_size_exp - mid_cnt_exp;
+
+	struct PageBitmap
+	{
+		uint64_t epoch;
+		uint64_t bits[words_per_page];
+	};
+	struct Leaf
+	{
+		PageBitmap pages[ 1 << leaf_page_cnt_exp ];
+	};
+	struct Mid
+	{
+		Leaf* leaves[ 1 << mid_cnt_exp ];
+	};
+	static constexpr size_t leafAllocSize = alignUpExp( sizeof( Leaf ), PAGE_SIZE_EXP );
+	static constexpr size_t midAllocSize = alignUpExp( sizeof( Mid ), PAGE_SIZE_EXP );
+	static constexpr size_t topAllocSize = alignUpExp( sizeof( Mid* ) << top_cnt_exp, PAGE_SIZE_EXP );
+
+	Mid** top = nullptr;
+	uint64_t currentEpoch = 1; // newly allocated (zeroed) bitmaps are of epoch 0, that is, empty
+	size_t markCount = 0; // since last clear()
+
+	NODECPP_FORCEINLINE const PageBitmap* findPage( uintptr_t page ) const
+	{
+		if ( top == nullptr )
+			return nullptr;
+		Mid* mid = top[ page >> ( leaf_page_cnt_exp + mid_cnt_exp ) ];
+		if ( mid == nullptr )
+			return nullptr;
+		Leaf* leaf = mid->leaves[ ( page >> leaf_page_cnt_exp ) & ( ( 1 << mid_cnt_exp ) - 1 ) ];
+		if ( leaf == nullptr )
+			return nullptr;
+		return leaf->pages + ( page & ( ( 1 << leaf_page_cnt_exp ) - 1 ) );
+	}
+
+	PageBitmap& getOrCreatePage( uintptr_t page )
+	{
+		if ( top == nullptr )
+			top = reinterpret_cast<Mid**>( this->getFreeBlockNoCache( topAllocSize ) ); // zeroed by OS
+		Mid*& mid = top[ page >> ( leaf_page_cnt_exp + mid_cnt_exp ) ];
+		if ( mid == nullptr )
+			mid = reinterpret_cast<Mid*>( this->getFreeBlockNoCache( midAllocSize ) );
+		Leaf*& leaf = mid->leaves[ ( page >> leaf_page_cnt_exp ) & ( ( 1 << mid_cnt_exp ) - 1 ) ];
+		if ( leaf == nullptr )
+			leaf = reinterpret_cast<Leaf*>( this->getFreeBlockNoCache( leafAllocSize ) );
+		PageBitmap& ret = leaf->pages[ page & ( ( 1 << leaf_page_cnt_exp ) - 1 ) ];
+		if ( ret.epoch != currentEpoch )
+		{
+			memset( ret.bits, 0, sizeof( ret.bits ) );
+			ret.epoch = currentEpoch;
+		}
+		return ret;
+	}
+
+	// sets (or clears) bits [from, to) of a page bitmap
+	template<bool set>
+	static NODECPP_FORCEINLINE void updateBits( PageBitmap& bitmap, size_t from, size_t to )
+	{
+		while ( from < to )
+		{
+			size_t word = from >> 6;
+			size_t wordEnd = ( word + 1 ) << 6;
+			size_t end = to < wordEnd ? to : wordEnd;
+			uint64_t mask = ( end - from == 64 ) ? ~(uint64_t)0 : ( ( ( (uint64_t)1 ) << ( end - from ) ) - 1 ) << ( from & 63 );
+			if constexpr ( set )
+				bitmap.bits[word] |= mask;
+			else
+				bitmap.bits[word] &= ~mask;
+			from = end;
+		}
+	}
+
+public:
+	void initialize( uint8_t blockSizeExp )
+	{
+		if ( top != nullptr )
+			deinitialize();
+		BasePageAllocator::initialize( blockSizeExp );
+		currentEpoch = 1;
+		markCount = 0;
+	}
+
+	void deinitialize()
+	{
+		if ( top != nullptr )
+		{
+			for ( size_t i=0; i<((size_t)1<<top_cnt_exp); ++i )
+				if ( top[i] != nullptr )
+				{
+					for ( size_t j=0; j<((size_t)1<<mid_cnt_exp); ++j )
+						if ( top[i]->leaves[j] != nullptr )
+							this->freeChunkNoCache( top[i]->leaves[j], leafAllocSize );
+					this->freeChunkNoCache( top[i], midAllocSize );
+				}
+			this->freeChunkNoCache( top, topAllocSize );
+			top = nullptr;
+		}
+		BasePageAllocator::deinitialize();
+	}
+
+	void markZombie( void* ptr, size_t sz )
+	{
+		uintptr_t begin = (uintptr_t)ptr;
+		uintptr_t end = begin + sz;
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ( begin & ( ( 1 << granule_exp ) - 1 ) ) == 0 && ( sz & ( ( 1 << granule_exp ) - 1 ) ) == 0 );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ( end >> address_bits ) == 0 );
+		++markCount;
+		while ( begin < end )
+		{
+			uintptr_t pageEnd = ( begin | PAGE_SIZE_MASK ) + 1;
+			uintptr_t chunkEnd = end < pageEnd ? end : pageEnd;
+			PageBitmap& bitmap = getOrCreatePage( begin >> PAGE_SIZE_EXP );
+			updateBits<true>( bitmap, ( begin & PAGE_SIZE_MASK ) >> granule_exp, ( ( chunkEnd - 1 ) & PAGE_SIZE_MASK ) / ( 1 << granule_exp ) + 1 );
+			begin = chunkEnd;
+		}
+	}
+
+	// reverts markZombie( ptr, sz ) for a zombie being released individually (that is, not by clear())
+	void unmarkZombie( void* ptr, size_t sz )
+	{
+		uintptr_t begin = (uintptr_t)ptr;
+		uintptr_t end = begin + sz;
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, markCount != 0 );
+		--markCount;
+		while ( begin < end )
+		{
+			uintptr_t pageEnd = ( begin | PAGE_SIZE_MASK ) + 1;
+			uintptr_t chunkEnd = end < pageEnd ? end : pageEnd;
+			PageBitmap* bitmap = const_cast<PageBitmap*>( findPage( begin >> PAGE_SIZE_EXP ) );
+			if ( bitmap != nullptr && bitmap->epoch == currentEpoch )
+				updateBits<false>( *bitmap, ( begin & PAGE_SIZE_MASK ) >> granule_exp, ( ( chunkEnd - 1 ) & PAGE_SIZE_MASK ) / ( 1 << granule_exp ) + 1 );
+			begin = chunkEnd;
+		}
+	}
+
+	NODECPP_FORCEINLINE bool isZombie( const void* ptr ) const
+	{
+		uintptr_t addr = (uintptr_t)ptr;
+		if ( ( addr >> address_bits ) != 0 )
+			return false;
+		const PageBitmap* bitmap = findPage( addr >> PAGE_SIZE_EXP );
+		if ( bitmap == nullptr || bitmap->epoch != currentEpoch )
+			return false;
+		size_t bit = ( addr & PAGE_SIZE_MASK ) >> granule_exp;
+		return ( bitmap->bits[ bit >> 6 ] >> ( bit & 63 ) ) & 1;
+	}
+
+	NODECPP_FORCEINLINE void clear()
+	{
+		++currentEpoch;
+		markCount = 0;
+	}
+
+	bool empty() const { return markCount == 0; }
+};
+#endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+
+#ifndef NODECPP_DISABLE_ZOMBIE_PREFIX
+// FIFO list of zombies linked through their prefixes (see guaranteed_prefix_size).
+// Push and pop counts are kept since initialization: a zombie is identified in order of death by the push count at its death
+class ZombieList
+{
+	void* first;
+	void* last;
+	uint64_t pushCount;
+	uint64_t popCount;
+
+public:
+	void initialize()
+	{
+		first = nullptr;
+		last = nullptr;
+		pushCount = 0;
+		popCount = 0;
+	}
+
+	NODECPP_FORCEINLINE bool empty() const { return pushCount == popCount; }
+	NODECPP_FORCEINLINE uint64_t getPushCount() const { return pushCount; }
+	NODECPP_FORCEINLINE uint64_t getPopCount() const { return popCount; }
+
+	NODECPP_FORCEINLINE void push( void* ptr )
+	{
+		if ( first ) // LIKELY
+			*reinterpret_cast<void**>( last ) = ptr;
+		else
+			first = ptr;
+		last = ptr;
+		++pushCount;
+	}
+
+	NODECPP_FORCEINLINE void* pop()
+	{
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, !empty() );
+		void* ret = first;
+		if ( ret == last )
+		{
+			first = nullptr;
+			last = nullptr;
+		}
+		else
+			first = *reinterpret_cast<void**>( ret );
+		++popCount;
+		return ret;
+	}
+
+	// pops all zombies to a list linked through their first words; returns a new head of 'freeList'
+	NODECPP_FORCEINLINE void* spliceToFreeList( void* freeList )
+	{
+		if ( first )
+		{
+			*reinterpret_cast<void**>( last ) = freeList;
+			freeList = first;
+			first = nullptr;
+			last = nullptr;
+			popCount = pushCount;
+		}
+		return freeList;
+	}
+};
+#else
+// Storage for out-of-band zombie lists: fixed-size segments carved from pages of a page allocator and recycled through a free list. 
+// Pages are linked through their first word (that is, the first segment of each page is never used) and are returned at deinitialize()
+template<class BasePageAllocator>
+class ZombieListSegmentPool : public BasePageAllocator
+{
+public:
+	static constexpr size_t segment_size = 512;
+	struct Segment
+	{
+		Segment* next;
+		void* items[ segment_size / sizeof(void*) - 1 ];
+	};
+	static constexpr size_t segment_capacity = sizeof(Segment::items) / sizeof(void*);
+	static_assert( sizeof(Segment) == segment_size );
+
+private:
+	Segment* freeSegments;
+	void* pages;
+
+public:
+	void initialize( uint8_t blockSizeExp )
+	{
+		BasePageAllocator::initialize( blockSizeExp );
+		freeSegments = nullptr;
+		pages = nullptr;
+	}
+
+	NODECPP_FORCEINLINE Segment* allocateSegment()
+	{
+		if ( freeSegments == nullptr ) // UNLIKELY
+		{
+			uint8_t* page = reinterpret_cast<uint8_t*>( this->getFreeBlockNoCache( PAGE_SIZE_BYTES ) );
+			*reinterpret_cast<void**>( page ) = pages;
+			pages = page;
+			for ( size_t i=PAGE_SIZE_BYTES/segment_size-1; i!=0; --i )
+				freeSegment( reinterpret_cast<Segment*>( page + i * segment_size ) );
+		}
+		Segment* ret = freeSegments;
+		freeSegments = ret->next;
+		return ret;
+	}
+
+	NODECPP_FORCEINLINE void freeSegment( Segment* segment )
+	{
+		segment->next = freeSegments;
+		freeSegments = segment;
+	}
+
+	void deinitialize()
+	{
+		while ( pages != nullptr )
+		{
+			void* next = *reinterpret_cast<void**>( pages );
+			this->freeChunkNoCache( pages, PAGE_SIZE_BYTES );
+			pages = next;
+		}
+		freeSegments = nullptr;
+		BasePageAllocator::deinitialize();
+	}
+};
+
+// FIFO list of zombies kept out of band, as a queue of pointers in segments of a ZombieListSegmentPool; 
+// nothing is written to zombie memory until it is spliced to a free list.
+// Push and pop counts are kept since initialization: a zombie is identified in order of death by the push count at its death
+class ZombieList
+{
+	using SegmentPool = ZombieListSegmentPool<PageAllocatorWithCaching>;
+	using Segment = SegmentPool::Segment;
+
+	SegmentPool* pool;
+	Segment* head; // the oldest items
+	Segment* tail;
+	size_t headIdx; // of the next item to pop
+	size_t tailIdx; // of the next item to push
+	uint64_t pushCount;
+	uint64_t popCount;
+
+public:
+	void initialize( SegmentPool* pool_ )
+	{
+		pool = pool_;
+		head = nullptr;
+		tail = nullptr;
+		headIdx = 0;
+		tailIdx = 0;
+		pushCount = 0;
+		popCount = 0;
+	}
+
+	NODECPP_FORCEINLINE bool empty() const { return pushCount == popCount; }
+	NODECPP_FORCEINLINE uint64_t getPushCount() const { return pushCount; }
+	NODECPP_FORCEINLINE uint64_t getPopCount() const { return popCount; }
+
+	NODECPP_FORCEINLINE void push( void* ptr )
+	{
+		if ( tail == nullptr || tailIdx == SegmentPool::segment_capacity ) // UNLIKELY
+		{
+			Segment* segment = pool->allocateSegment();
+			segment->next = nullptr;
+			if ( tail != nullptr )
+				tail->next = segment;
+			else
+			{
+				head = segment;
+				headIdx = 0;
+			}
+			tail = segment;
+			tailIdx = 0;
+		}
+		tail->items[tailIdx++] = ptr;
+		++pushCount;
+	}
+
+	NODECPP_FORCEINLINE void* pop()
+	{
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, !empty() );
+		void* ret = head->items[headIdx++];
+		++popCount;
+		if ( head == tail && headIdx == tailIdx )
+		{
+			pool->freeSegment( head );
+			head = nullptr;
+			tail = nullptr;
+			headIdx = 0;
+			tailIdx = 0;
+		}
+		else if ( headIdx == SegmentPool::segment_capacity )
+		{
+			Segment* next = head->next;
+			pool->freeSegment( head );
+			head = next;
+			headIdx = 0;
+		}
+		return ret;
+	}
+
+	// pops all zombies to a list linked through their first words; returns a new head of 'freeList'
+	NODECPP_FORCEINLINE void* spliceToFreeList( void* freeList )
+	{
+		while ( !empty() )
+		{
+			void* ptr = pop();
+			*reinterpret_cast<void**>( ptr ) = freeList;
+			freeList = ptr;
+		}
+		return freeList;
+	}
+};
+#endif // NODECPP_DISABLE_ZOMBIE_PREFIX
+
+struct QuarantineStats
+{
+	uint64_t currentSize = 0;
+	uint64_t peakSize = 0; // since initialization
+	// automatic release (see SafeIibAllocator::setQuarantineBudget())
+	uint64_t autoReleaseCount = 0;
+	uint64_t autoReleasedZombieCount = 0;
+	uint64_t autoReleasedSize = 0;
+	// interior pages of large zombies, discarded or protected (see SafeIibAllocator::setLargeZombieMode())
+	uint64_t currentHiddenSize = 0;
+	uint64_t hiddenSize = 0; // since initialization
+
+	void printStats() const
+	{
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::iibmalloc_module_id), "Quarantine {} (peak {}, of which {} hidden), auto-released {} times: {} zombies ({})\n", currentSize, peakSize, currentHiddenSize, autoReleaseCount, autoReleasedZombieCount, autoReleasedSize );
+	}
+};
 
 class SafeIibAllocator : protected IibAllocatorBase
 {
+#ifndef NODECPP_DISABLE_ZOMBIE_PREFIX
 	static_assert( guaranteed_prefix_size >= sizeof(void*) ); // required to keep zombie list item pointer 'next' inside a block
+#endif // NODECPP_DISABLE_ZOMBIE_PREFIX
+
+public:
+	// what happens to interior pages (all but the first one, which keeps the chunk header and the prefix, if any) of large zombies
+	enum class LargeZombieMode { keep, discard, protect };
+	static constexpr size_t default_min_hidden_large_zombie_size = PAGE_SIZE_BYTES * 8;
 
 	static std::atomic<uint16_t> allocatorIDBase;
 	uint16_t allocatorID_;
 
 protected:
-	void** zombieBucketsFirst[BucketCount];
-	void** zombieBucketsLast[BucketCount];
-	void* zombieLargeChunks;
+	ZombieList zombieLists[BucketCount + 1]; // [BucketCount] is for large chunks
+#ifdef NODECPP_DISABLE_ZOMBIE_PREFIX
+	ZombieListSegmentPool<PageAllocatorWithCaching> zombieListSegments;
+#endif // NODECPP_DISABLE_ZOMBIE_PREFIX
+
+	// Zombie lists are kept in the order of death. To release zombies of old epochs without storing anything in zombie memory, 
+	// advanceZombieEpoch() records push counts of all zombie lists: a zombie pushed before a recorded count died within a respective or earlier epoch
+	static constexpr size_t max_pending_zombie_epochs = 16;
+	struct ZombieEpochMark
+	{
+		uint64_t epoch; // the latest epoch covered by this mark
+		uint64_t pushCount[BucketCount + 1];
+	};
+	ZombieEpochMark zombieEpochMarks[max_pending_zombie_epochs]; // ring, from the oldest to the newest
+	size_t zombieEpochMarkBegin;
+	size_t zombieEpochMarkCount;
+	uint64_t zombieEpoch;
+
+	// quarantine: memory held by zombies ([BucketCount] is for large chunks)
+	size_t zombieBytes[BucketCount + 1];
+	size_t zombieBytesTotal;
+	size_t quarantineBudget; // 0 for unlimited
+	size_t minQuarantineEpochs;
+	static constexpr size_t quarantine_auto_release_step = 64; // max number of zombies released by a single zombieableDeallocate() call over budget
+	QuarantineStats quarantineStats;
+
+	LargeZombieMode largeZombieMode;
+	size_t minHiddenLargeZombieSize;
 
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-	class ThisAllocator
-	{
-		IibAllocatorBase* allocator;
-	public:
-		static constexpr bool objectRequired = true;
-		static constexpr size_t guaranteed_alignment = NODECPP_GUARANTEED_IIBMALLOC_ALIGNMENT;
-	public:
-		ThisAllocator( IibAllocatorBase* allocator_ ) : allocator( allocator_ ) {}
-		ThisAllocator( const ThisAllocator& other ) = default;
-		ThisAllocator& operator = ( const ThisAllocator& other ) = default;
-		ThisAllocator( ThisAllocator&& other ) = delete;
-		ThisAllocator& operator = ( ThisAllocator&& other ) = delete;
-		template<size_t alignment = 0> 
-		NODECPP_FORCEINLINE void* allocate( size_t allocSize ) { return allocator->allocateAligned<alignment>( allocSize ); }
-		template<size_t alignment = 0> 
-		NODECPP_FORCEINLINE void deallocate( void* ptr ) { allocator->deallocate( ptr ); }
-	};
-	template<class _Ty>
-	using thisallocator = ::nodecpp::selective_allocator<ThisAllocator, _Ty>; // NOTE: map::ctor perform allocations. Since mechanics of ThisAllocator assumes ptr to current allocator which is yet to be set at tome of allocator creation, this won't work. If iibmalloc is desired for such purposes further consideration is necessary
-//	using thisallocator = ::nodecpp::selective_allocator<StdRawAllocator, _Ty>;
-	using dataptrt = uint8_t*;
-	std::map<uint8_t*, size_t, std::greater<uint8_t*>, thisallocator<std::pair<const dataptrt, size_t>>> zombieMap;
+	ZombiePageMap<PageAllocatorWithCaching, reservation_size_exp> zombieMap;
 	bool doZombieEarlyDetection_ = true;
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 	
 public:
-	SafeIibAllocator() : zombieMap( thisallocator<std::pair<const dataptrt, size_t>>(ThisAllocator(this) ) ) { initialize(); }
+	SafeIibAllocator() { initialize(); }
 	SafeIibAllocator(const SafeIibAllocator&) = delete;
 	SafeIibAllocator(SafeIibAllocator&&) = default;
 	SafeIibAllocator& operator=(const SafeIibAllocator&) = delete;
 	SafeIibAllocator& operator=(SafeIibAllocator&&) = default;
-	
+
+private:
+	NODECPP_FORCEINLINE bool isLargeZombieHidden( size_t allocSize ) const { return largeZombieMode != LargeZombieMode::keep && allocSize >= minHiddenLargeZombieSize; }
+
+	NODECPP_NOINLINE void hideLargeZombie( void* ptr, size_t allocSize )
+	{
+		uint8_t* interior = reinterpret_cast<uint8_t*>( PageAllocatorT::ptrToPageStart( ptr ) ) + PAGE_SIZE_BYTES;
+		size_t interiorSize = allocSize - PAGE_SIZE_BYTES;
+		VirtualMemoryHints::discard( interior, interiorSize );
+		if ( largeZombieMode == LargeZombieMode::protect )
+			VirtualMemoryHints::protectNoAccess( interior, interiorSize );
+		quarantineStats.currentHiddenSize += interiorSize;
+		quarantineStats.hiddenSize += interiorSize;
+	}
+
+	// to be called before a hidden large zombie is deallocated
+	NODECPP_NOINLINE void unhideLargeZombie( void* ptr, size_t allocSize )
+	{
+		uint8_t* interior = reinterpret_cast<uint8_t*>( PageAllocatorT::ptrToPageStart( ptr ) ) + PAGE_SIZE_BYTES;
+		size_t interiorSize = allocSize - PAGE_SIZE_BYTES;
+		if ( largeZombieMode == LargeZombieMode::protect )
+			VirtualMemoryHints::protectReadWrite( interior, interiorSize );
+		quarantineStats.currentHiddenSize -= interiorSize;
+	}
+
+	// releases zombies that died before 'epoch' (oldest first) until 'budget' zombies are released, or quarantine is not above 'bytesToKeep'
+	size_t releaseZombies( uint64_t epoch, size_t budget, size_t bytesToKeep )
+	{
+		constexpr size_t memForbidden = alignUpExp( BulkAllocatorT::reservedSizeAtPageStart(), ALIGNMENT_EXP );
+		size_t released = 0;
+		while ( zombieEpochMarkCount != 0 && zombieEpochMarks[zombieEpochMarkBegin].epoch < epoch )
+		{
+			ZombieEpochMark& mark = zombieEpochMarks[zombieEpochMarkBegin];
+			for ( size_t idx=0; idx<=BucketCount; ++idx )
+			{
+				while ( zombieLists[idx].getPopCount() < mark.pushCount[idx] )
+				{
+					if ( released == budget || zombieBytesTotal <= bytesToKeep )
+						return released;
+					void* curr = zombieLists[idx].pop();
+					size_t allocSize = IibAllocatorBase::getAllocatedSize( curr );
+					zombieBytes[idx] -= allocSize;
+					zombieBytesTotal -= allocSize;
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+					if ( doZombieEarlyDetection_ )
+						zombieMap.unmarkZombie( curr, idx < BucketCount ? allocSize : allocSize - memForbidden );
+#endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+					if ( idx == BucketCount && isLargeZombieHidden( allocSize ) )
+						unhideLargeZombie( curr, allocSize );
+					IibAllocatorBase::deallocate( curr );
+					++released;
+				}
+			}
+			zombieEpochMarkBegin = ( zombieEpochMarkBegin + 1 ) % max_pending_zombie_epochs;
+			--zombieEpochMarkCount;
+		}
+		return released;
+	}
+
+	NODECPP_NOINLINE void releaseZombiesOverQuarantineBudget()
+	{
+		size_t before = zombieBytesTotal;
+		size_t released = releaseZombies( zombieEpoch + 1 - minQuarantineEpochs, quarantine_auto_release_step, quarantineBudget );
+		if ( released )
+		{
+			++(quarantineStats.autoReleaseCount);
+			quarantineStats.autoReleasedZombieCount += released;
+			quarantineStats.autoReleasedSize += before - zombieBytesTotal;
+		}
+	}
+
+public:
 	auto allocatorID() { return allocatorID_; }
 
 	using IibAllocatorBase::maximalSupportedAlignment;
@@ -1414,6 +2222,12 @@ public:
 		IibAllocatorBase::deallocate( ptr );
 	}
 
+	// for memory obtained by allocate(); zombieable memory cannot be reallocated, as its old address would not become a zombie
+	NODECPP_FORCEINLINE void* reallocate(void* ptr, size_t sz)
+	{
+		return IibAllocatorBase::reallocate( ptr, sz );
+	}
+
 	NODECPP_FORCEINLINE size_t isPointerInBlock(void* allocatedPtr, void* ptr )
 	{
 		return ptr >= allocatedPtr && reinterpret_cast<uint8_t*>(ptr) < reinterpret_cast<uint8_t*>(allocatedPtr) + IibAllocatorBase::getAllocatedSize( ptr );
@@ -1445,66 +2259,85 @@ public:
 		void* ptr = reinterpret_cast<uint8_t*>(userPtr) - guaranteed_prefix_size;
 		if(ptr)
 		{
-#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
-			if ( doZombieEarlyDetection_ )
+			size_t offsetInPage = PageAllocatorT::getOffsetInPage( ptr );
+			constexpr size_t memForbidden = alignUpExp( BulkAllocatorT::reservedSizeAtPageStart(), ALIGNMENT_EXP );
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+			if ( offsetInPage != memForbidden ) // small and medium size: a stale pointer is told by its generation, thus no quarantine
 			{
-				size_t allocSize = IibAllocatorBase::getAllocatedSize(ptr);
-				zombieMap.insert( std::make_pair( reinterpret_cast<uint8_t*>(ptr), allocSize ) );
+				++(*PageAllocatorT::slotGenerationAddress( ptr ));
+				IibAllocatorBase::deallocate( ptr );
+				return;
 			}
+#endif // NODECPP_USE_SLOT_GENERATIONS
+			size_t allocSize = IibAllocatorBase::getAllocatedSize( ptr );
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+			if ( doZombieEarlyDetection_ )
+				zombieMap.markZombie( ptr, offsetInPage != memForbidden ? allocSize : allocSize - memForbidden ); // size of a bulk chunk is counted from its page start
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 
-			size_t offsetInPage = PageAllocatorT::getOffsetInPage( ptr );
-			constexpr size_t memForbidden = alignUpExp( BulkAllocatorT::reservedSizeAtPageStart(), ALIGNMENT_EXP );
+			zombieBytesTotal += allocSize;
+			if ( zombieBytesTotal > quarantineStats.peakSize )
+				quarantineStats.peakSize = zombieBytesTotal;
 			if ( offsetInPage != memForbidden ) // small and medium size
 			{
 				size_t idx = PageAllocatorT::addressToIdx( ptr );
-				if ( zombieBucketsFirst[idx] ) // LIKELY
-				{
-					if ( zombieBucketsLast[idx] )
-						*(zombieBucketsLast[idx]) = ptr;
-					zombieBucketsLast[idx] = reinterpret_cast<void**>( ptr );
-				}
-				else
-				{
-					zombieBucketsFirst[idx] = reinterpret_cast<void**>( ptr );
-					if ( zombieBucketsLast[idx] )
-						*(zombieBucketsLast[idx]) = ptr;
-					zombieBucketsLast[idx] = reinterpret_cast<void**>( ptr );
-				}
+				zombieBytes[idx] += allocSize;
+				zombieLists[idx].push( ptr );
 			}
 			else
 			{
-				*reinterpret_cast<void**>( ptr ) = zombieLargeChunks;
-				zombieLargeChunks = ptr;
+				zombieBytes[BucketCount] += allocSize;
+				if ( isLargeZombieHidden( allocSize ) )
+					hideLargeZombie( ptr, allocSize );
+				zombieLists[BucketCount].push( ptr );
 			}
+
+			if ( quarantineBudget != 0 && zombieBytesTotal > quarantineBudget )
+				releaseZombiesOverQuarantineBudget();
 		}
 	}
 
 	NODECPP_FORCEINLINE size_t isZombieablePointerInBlock(void* allocatedPtr, void* ptr )
 	{
-		void* trueAllocatedPtr = reinterpret_cast<void**>(allocatedPtr) - 1;
+		void* trueAllocatedPtr = reinterpret_cast<uint8_t*>(allocatedPtr) - guaranteed_prefix_size;
 		return ptr >= allocatedPtr && reinterpret_cast<uint8_t*>(ptr) < reinterpret_cast<uint8_t*>(allocatedPtr) + IibAllocatorBase::getAllocatedSize( trueAllocatedPtr );
 	}
 
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 	NODECPP_FORCEINLINE bool isPointerNotZombie( void* ptr )
 	{
-		if ( doZombieEarlyDetection_ )
-		{
-			auto iter = zombieMap.lower_bound( reinterpret_cast<uint8_t*>( ptr ) );
-			if ( iter != zombieMap.end() )
-			{
-				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ptr >= iter->first );
-				return reinterpret_cast<uint8_t*>( ptr ) >= iter->first + iter->second;
-			}
-			else
-				return true;
-		}
-		else
-			return true;
+		return !doZombieEarlyDetection_ || !zombieMap.isZombie( ptr );
 	}
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+	// Small and medium chunks are reused right on zombieableDeallocate(), which bumps their generation instead. 
+	// A generation is to be recorded along with a pointer returned by zombieableAllocate*(); the pointer is stale once generations differ. 
+	// Generations wrap around (after 256 deallocations of the same slot, a stale pointer passes the check); 
+	// large chunks have no generation and go to quarantine as usual (for them, the check is isPointerNotZombie( ptr ), if available)
+	typedef PageAllocatorT::SlotGeneration SlotGeneration;
+
+	static NODECPP_FORCEINLINE SlotGeneration getSlotGeneration( void* allocatedPtr )
+	{
+		void* ptr = reinterpret_cast<uint8_t*>(allocatedPtr) - guaranteed_prefix_size;
+		constexpr size_t memForbidden = alignUpExp( BulkAllocatorT::reservedSizeAtPageStart(), ALIGNMENT_EXP );
+		return PageAllocatorT::getOffsetInPage( ptr ) != memForbidden ? *PageAllocatorT::slotGenerationAddress( ptr ) : 0;
+	}
+
+	NODECPP_FORCEINLINE bool isPointerNotZombie( void* allocatedPtr, SlotGeneration generation )
+	{
+		void* ptr = reinterpret_cast<uint8_t*>(allocatedPtr) - guaranteed_prefix_size;
+		constexpr size_t memForbidden = alignUpExp( BulkAllocatorT::reservedSizeAtPageStart(), ALIGNMENT_EXP );
+		if ( PageAllocatorT::getOffsetInPage( ptr ) != memForbidden ) // LIKELY
+			return *PageAllocatorT::slotGenerationAddress( ptr ) == generation;
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+		return isPointerNotZombie( allocatedPtr );
+#else
+		return true;
+#endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+	}
+#endif // NODECPP_USE_SLOT_GENERATIONS
+
 	NODECPP_FORCEINLINE void killAllZombies()
 	{
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
@@ -1512,27 +2345,99 @@ public:
 		zombieMap.clear();
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 		for ( size_t idx=0; idx<BucketCount; ++idx)
+			buckets[idx] = reinterpret_cast<void**>( zombieLists[idx].spliceToFreeList( buckets[idx] ) );
+		while ( !zombieLists[BucketCount].empty() )
 		{
-			if ( zombieBucketsLast[idx] )
+			void* curr = zombieLists[BucketCount].pop();
+			if ( largeZombieMode != LargeZombieMode::keep )
 			{
-				*(zombieBucketsLast[idx]) = buckets[idx];
-				buckets[idx] = *(zombieBucketsFirst[idx]);
+				size_t allocSize = IibAllocatorBase::getAllocatedSize( curr );
+				if ( isLargeZombieHidden( allocSize ) )
+					unhideLargeZombie( curr, allocSize );
 			}
-			zombieBucketsFirst[idx] = nullptr;
-			zombieBucketsLast[idx] = nullptr;
+			void* pageStart = PageAllocatorT::ptrToPageStart( curr );
+			bulkAllocator.deallocate( pageStart );
 		}
-		while ( zombieLargeChunks != nullptr )
+		resetZombieEpochMarks();
+		for ( size_t i=0; i<=BucketCount; ++i )
+			zombieBytes[i] = 0;
+		zombieBytesTotal = 0;
+	}
+
+	uint64_t getZombieEpoch() const { return zombieEpoch; }
+
+	// Ends the current zombie epoch (that is, an epoch in which objects being zombieableDeallocate()'d now die); returns the new one.
+	// If too many epochs are pending release, zombies of the ending epoch are attributed to the newest pending one
+	uint64_t advanceZombieEpoch()
+	{
+		ZombieEpochMark* mark;
+		if ( zombieEpochMarkCount < max_pending_zombie_epochs )
 		{
-			void* next = *reinterpret_cast<void**>( zombieLargeChunks );
-			void* pageStart = PageAllocatorT::ptrToPageStart( zombieLargeChunks );
-			bulkAllocator.deallocate( pageStart );
-			zombieLargeChunks = next;
+			mark = zombieEpochMarks + ( zombieEpochMarkBegin + zombieEpochMarkCount ) % max_pending_zombie_epochs;
+			++zombieEpochMarkCount;
 		}
+		else
+			mark = zombieEpochMarks + ( zombieEpochMarkBegin + zombieEpochMarkCount - 1 ) % max_pending_zombie_epochs;
+		for ( size_t i=0; i<=BucketCount; ++i )
+			mark->pushCount[i] = zombieLists[i].getPushCount();
+		mark->epoch = zombieEpoch;
+		return ++zombieEpoch;
 	}
+
+	// Releases (in the order of death) up to 'budget' zombies that died in epochs before 'epoch'; returns the number of zombies released.
+	// A return value less than 'budget' means that no such zombies remain
+	size_t releaseZombies( uint64_t epoch, size_t budget ) { return releaseZombies( epoch, budget, 0 ); }
+
+	// Once quarantine exceeds 'bytes' (0 for no limit), zombieableDeallocate() releases the oldest zombies automatically, 
+	// but never those that died within the current epoch or 'minEpochs' - 1 epochs before it (that is, the minimal quarantine time is kept); 
+	// with no advanceZombieEpoch() calls, nothing is released automatically
+	void setQuarantineBudget( size_t bytes, size_t minEpochs = 1 )
+	{
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, minEpochs >= 1 );
+		quarantineBudget = bytes;
+		minQuarantineEpochs = minEpochs;
+	}
+	size_t getQuarantineBudget() const { return quarantineBudget; }
+
+	// Interior pages of large zombies of at least 'minChunkSize' bytes (including the chunk header) can be discarded right away 
+	// (RSS drops on deallocation, at a cost of a system call), or also protected (then access to a zombie faults in hardware). 
+	// Can be changed only while there are no large zombies
+	void setLargeZombieMode( LargeZombieMode mode, size_t minChunkSize = default_min_hidden_large_zombie_size )
+	{
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, zombieLists[BucketCount].empty(), "to (re)set setLargeZombieMode() there must be no large zombies" );
+		largeZombieMode = mode;
+		minHiddenLargeZombieSize = minChunkSize > 2 * PAGE_SIZE_BYTES ? minChunkSize : 2 * PAGE_SIZE_BYTES;
+	}
+	LargeZombieMode getLargeZombieMode() const { return largeZombieMode; }
+
+	// memory held by zombies
+	size_t getQuarantineSize() const { return zombieBytesTotal; }
+	// same for a bucket; idx == BucketCount for large chunks
+	size_t getQuarantineSize( size_t idx ) const { NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, idx <= BucketCount ); return zombieBytes[idx]; }
+	QuarantineStats getQuarantineStats() const { QuarantineStats ret = quarantineStats; ret.currentSize = zombieBytesTotal; return ret; }
+
+private:
+	void resetZombieEpochMarks()
+	{
+		zombieEpochMarkBegin = 0;
+		zombieEpochMarkCount = 0;
+	}
+
+public:
 	
 	const BlockStats& getStats() const { return IibAllocatorBase::getStats(); }
+	size_t getCommittedSize() const { return IibAllocatorBase::getCommittedSize(); }
+	size_t getSlowPathCount() const { return IibAllocatorBase::getSlowPathCount(); }
+
+	void setHugeChunkCacheLimits( size_t limit, uint64_t decayMs = BulkAllocatorT::default_huge_chunk_cache_decay_ms, size_t slackPercent = BulkAllocatorT::default_huge_chunk_cache_slack_percent ) { IibAllocatorBase::setHugeChunkCacheLimits( limit, decayMs, slackPercent ); }
+	void releaseHugeChunkCache( bool all = false ) { IibAllocatorBase::releaseHugeChunkCache( all ); }
+	HugeChunkCacheStats getHugeChunkCacheStats() const { return IibAllocatorBase::getHugeChunkCacheStats(); }
 	
-	void printStats() const { IibAllocatorBase::printStats(); }
+	void printStats() const 
+	{
+		IibAllocatorBase::printStats();
+		getQuarantineStats().printStats();
+	}
 
 	void initialize(size_t size)
 	{
@@ -1546,13 +2451,26 @@ public:
 			++allocatorIDBase;
 		allocatorID_ = allocatorIDBase;
 
-		for ( size_t i=0; i<BucketCount; ++i)
-		{
-			zombieBucketsFirst[i] = nullptr;
-			zombieBucketsLast[i] = nullptr;
-		}
-		zombieLargeChunks = nullptr;
+#ifndef NODECPP_DISABLE_ZOMBIE_PREFIX
+		for ( size_t i=0; i<=BucketCount; ++i )
+			zombieLists[i].initialize();
+#else
+		zombieListSegments.initialize( PAGE_SIZE_EXP );
+		for ( size_t i=0; i<=BucketCount; ++i )
+			zombieLists[i].initialize( &zombieListSegments );
+#endif // NODECPP_DISABLE_ZOMBIE_PREFIX
+		resetZombieEpochMarks();
+		zombieEpoch = 1;
+		for ( size_t i=0; i<=BucketCount; ++i )
+			zombieBytes[i] = 0;
+		zombieBytesTotal = 0;
+		quarantineBudget = 0;
+		minQuarantineEpochs = 1;
+		quarantineStats = QuarantineStats();
+		largeZombieMode = LargeZombieMode::keep;
+		minHiddenLargeZombieSize = default_min_hidden_large_zombie_size;
 #ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+		zombieMap.initialize( PAGE_SIZE_EXP );
 		doZombieEarlyDetection_ = true;
 #endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
 	}
@@ -1568,6 +2486,12 @@ public:
 
 	~SafeIibAllocator()
 	{
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+		zombieMap.deinitialize();
+#endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+#ifdef NODECPP_DISABLE_ZOMBIE_PREFIX
+		zombieListSegments.deinitialize();
+#endif // NODECPP_DISABLE_ZOMBIE_PREFIX
 	}
 };
 
@@ -124,6 +124,32 @@ namespace nodecpp::iibmalloc
 	{
 		return ( ((uintptr_t)(-((intptr_t)((((uintptr_t)(-((intptr_t)sz))))) >> alignmentExp ))) << alignmentExp);
 	}
+
+	// position of the lowest set bit; 'mask' must not be 0
+	NODECPP_FORCEINLINE
+	size_t lowestSetBit(uint64_t mask)
+	{
+#ifdef NODECPP_MSVC
+		unsigned long ix;
+		_BitScanForward64(&ix, mask);
+		return ix;
+#else
+		return __builtin_ctzll(mask);
+#endif
+	}
+
+	// position of the highest set bit; 'mask' must not be 0
+	NODECPP_FORCEINLINE
+	size_t highestSetBit(uint64_t mask)
+	{
+#ifdef NODECPP_MSVC
+		unsigned long ix;
+		_BitScanReverse64(&ix, mask);
+		return ix;
+#else
+		return 63 - __builtin_clzll(mask);
+#endif
+	}
 } // namespace nodecpp::iibmalloc
 
 
@@ -206,6 +206,15 @@ public:
 	size_t getCount() const { return count; }
 };
 
+// OS memory hints beyond VirtualMemory (implemented in iibmalloc.cpp); addr and size must be page-aligned
+struct VirtualMemoryHints
+{
+	static void discard( void* addr, size_t size ); // physical pages are released; range stays accessible, its content becomes undefined
+	static void protectNoAccess( void* addr, size_t size );
+	static void protectReadWrite( void* addr, size_t size );
+	static void* remap( void* addr, size_t oldSize, size_t newSize ); // resizes a mapping without copying (may move it); nullptr if failed or not supported (then the mapping is intact)
+};
+
 struct BlockStats
 {
 	//alloc / dealloc ops
@@ -223,6 +232,12 @@ struct BlockStats
 	uint64_t deallocRequestCount = 0;
 	uint64_t deallocRequestSize = 0;
 
+	// memory backed by the OS (committed explicitly, or allocated as committed), and memory returned back
+	uint64_t sysCommitCount = 0;
+	uint64_t sysCommitSize = 0;
+	uint64_t sysDecommitCount = 0;
+	uint64_t sysDecommitSize = 0;
+
 	void printStats() const
 	{
 		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::iibmalloc_module_id), "Allocs {} ({}), ", sysAllocCount, sysAllocSize);
@@ -232,8 +247,11 @@ struct BlockStats
 		uint64_t sz = sysAllocSize - sysDeallocSize;
 
 		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::iibmalloc_module_id), "Diff {} ({})\n", ct, sz);
+		nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::iibmalloc_module_id), "Committed {} (commits {} ({}), decommits {} ({}))\n", getCommittedSize(), sysCommitCount, sysCommitSize, sysDecommitCount, sysDecommitSize);
 	}
 
+	uint64_t getCommittedSize() const { return sysCommitSize - sysDecommitSize; }
+
 	void registerAllocRequest( size_t sz )
 	{
 		allocRequestSize += sz;
@@ -257,6 +275,17 @@ struct BlockStats
 		rdtscSysDeallocSpent += rdtscSpent;
 		++sysDeallocCount;
 	}
+
+	void registerSysCommit( size_t sz )
+	{
+		sysCommitSize += sz;
+		++sysCommitCount;
+	}
+	void registerSysDecommit( size_t sz )
+	{
+		sysDecommitSize += sz;
+		++sysDecommitCount;
+	}
 };
 
 struct PageAllocator // rather a proof of concept
@@ -285,6 +314,7 @@ public:
 
 		if (ptr)
 		{
+			stats.registerSysCommit( sz );
 			MemoryBlockListItem* chk = static_cast<MemoryBlockListItem*>(ptr);
 			chk->initialize(sz, 0);
 			return chk;
@@ -305,6 +335,7 @@ public:
 		VirtualMemory::deallocate(chk, sz );
 		uint64_t end = NODECPP_RDTSC();
 		stats.registerSysDealloc( sz, end - start );
+		stats.registerSysDecommit( sz );
 
 	}
 
@@ -321,11 +352,15 @@ public:
 	}
 	void* CommitMemory(void* addr, size_t size)
 	{
-		return VirtualMemory::CommitMemory( addr, size);
+		void* ret = VirtualMemory::CommitMemory( addr, size);
+		if (ret != (void*)(-1))
+			stats.registerSysCommit( size );
+		return ret;
 	}
 	void DecommitMemory(void* addr, size_t size)
 	{
 		VirtualMemory::DecommitMemory( addr, size );
+		stats.registerSysDecommit( size );
 	}
 	void FreeAddressSpace(void* addr, size_t size)
 	{
@@ -370,6 +405,7 @@ public:
 				VirtualMemory::deallocate(chk, sz );
 				uint64_t end = NODECPP_RDTSC();
 				stats.registerSysDealloc( sz, end - start );
+				stats.registerSysDecommit( sz );
 			}
 		}
 	}
@@ -398,6 +434,7 @@ public:
 
 		if (ptr)
 		{
+			stats.registerSysCommit( sz );
 			MemoryBlockListItem* chk = static_cast<MemoryBlockListItem*>(ptr);
 			chk->initialize(sz, ix);
 			return chk;
@@ -419,7 +456,10 @@ public:
 		stats.registerSysAlloc( sz, end - start );
 
 		if (ptr)
+		{
+			stats.registerSysCommit( sz );
 			return ptr;
+		}
 
 		throw std::bad_alloc();
 	}
@@ -447,9 +487,42 @@ public:
 		VirtualMemory::deallocate(chk, sz );
 		uint64_t end = NODECPP_RDTSC();
 		stats.registerSysDealloc( sz, end - start );
+		stats.registerSysDecommit( sz );
 	}
 
 	void freeChunkNoCache( void* block, size_t sz )
+	{
+		freeChunkNoCache( block, sz, sz );
+	}
+
+	// for blocks obtained by getFreeBlockNoCache(); returns nullptr if the block cannot be remapped (see VirtualMemoryHints::remap())
+	void* remapChunkNoCache( void* block, size_t sz, size_t newSz )
+	{
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, isAlignedExp(newSz, blockSizeExp));
+
+		uint64_t start = NODECPP_RDTSC();
+		void* ptr = VirtualMemoryHints::remap( block, sz, newSz );
+		uint64_t end = NODECPP_RDTSC();
+		if ( ptr == nullptr )
+			return nullptr;
+
+		if ( newSz > sz )
+		{
+			stats.registerAllocRequest( newSz - sz );
+			stats.registerSysAlloc( newSz - sz, end - start );
+			stats.registerSysCommit( newSz - sz );
+		}
+		else if ( newSz < sz )
+		{
+			stats.registerDeallocRequest( sz - newSz );
+			stats.registerSysDealloc( sz - newSz, end - start );
+			stats.registerSysDecommit( sz - newSz );
+		}
+		return ptr;
+	}
+
+	// for blocks that are committed only partially (committedSz bytes in total), such as address space reservations
+	void freeChunkNoCache( void* block, size_t sz, size_t committedSz )
 	{
 		stats.registerDeallocRequest( sz );
 
@@ -457,6 +530,7 @@ public:
 		VirtualMemory::deallocate( block, sz );
 		uint64_t end = NODECPP_RDTSC();
 		stats.registerSysDealloc( sz, end - start );
+		stats.registerSysDecommit( committedSz );
 	}
 
 	const BlockStats& getStats() const { return stats; }
@@ -478,11 +552,14 @@ public:
 		{
 			nodecpp::log::default_log::info( nodecpp::log::ModuleID(nodecpp::iibmalloc_module_id), "Committing failed at {} ({:x}) (0x{:x} bytes in total)", stats.allocRequestCount, stats.allocRequestCount, stats.allocRequestSize );
 		}
+		else
+			stats.registerSysCommit( size );
 		return ret;
 	}
 	void DecommitMemory(void* addr, size_t size)
 	{
 		VirtualMemory::DecommitMemory( addr, size );
+		stats.registerSysDecommit( size );
 	}
 	void FreeAddressSpace(void* addr, size_t size)
 	{
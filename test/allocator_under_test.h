@@ -0,0 +1,388 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Allocators under test: thin wrappers with a common init/allocate/deallocate/deinit 
+ *     interface that are shared by all test and benchmark drivers
+ * 
+ * -------------------------------------------------------------------------------*/
+#ifndef ALLOCATOR_UNDER_TEST_H
+#define ALLOCATOR_UNDER_TEST_H
+
+#include "test_common.h"
+
+#ifdef NODECPP_MSVC
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#ifdef NODECPP_WINDOWS
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+
+enum { TRY_ALL = 0xFFFFFFFF, USE_EMPTY_TEST = 0x1, USE_PER_THREAD_ALLOCATOR = 0x2, USE_NEW_DELETE = 0x4, USE_EXTERNAL_MALLOC = 0x8, };
+
+struct OpLatencyStats; // optional; see random_test.h
+
+struct CommonTestResults
+{
+	size_t threadID;
+
+	size_t innerDur;
+
+	uint64_t rdtscBegin;
+	uint64_t rdtscSetup;
+	uint64_t rdtscMainLoop;
+	uint64_t rdtscExit;
+
+	// sampled by test drivers at phase boundaries (process-wide)
+	MemoryFootprint memBegin;
+	MemoryFootprint memAfterSetup;
+	MemoryFootprint memAfterMainLoop;
+	MemoryFootprint memAfterExit;
+	uint64_t liveBytesAfterSetup; // as requested by a test driver
+	uint64_t liveBytesAfterMainLoop;
+
+	OpLatencyStats* latency; // if not null, latency of operations is sampled
+};
+
+struct ThreadTestRes : public CommonTestResults
+{
+	size_t sysAllocCallCntAfterSetup;
+	size_t sysDeallocCallCntAfterSetup;
+	size_t sysAllocCallCntAfterMainLoop;
+	size_t sysDeallocCallCntAfterMainLoop;
+	size_t sysAllocCallCntAfterExit;
+	size_t sysDeallocCallCntAfterExit;
+
+	uint64_t rdtscSysAllocCallSumAfterSetup;
+	uint64_t rdtscSysDeallocCallSumAfterSetup;
+	uint64_t rdtscSysAllocCallSumAfterMainLoop;
+	uint64_t rdtscSysDeallocCallSumAfterMainLoop;
+	uint64_t rdtscSysAllocCallSumAfterExit;
+	uint64_t rdtscSysDeallocCallSumAfterExit;
+
+	uint64_t allocRequestCountAfterSetup;
+	uint64_t deallocRequestCountAfterSetup;
+	uint64_t allocRequestCountAfterMainLoop;
+	uint64_t deallocRequestCountAfterMainLoop;
+	uint64_t allocRequestCountAfterExit;
+	uint64_t deallocRequestCountAfterExit;
+
+	uint64_t committedSizeAfterSetup; // as reported by the allocator
+	uint64_t committedSizeAfterMainLoop;
+	uint64_t committedSizeAfterExit;
+};
+
+class NewDeleteUnderTest
+{
+	CommonTestResults* testRes;
+	size_t start;
+
+public:
+	NewDeleteUnderTest( CommonTestResults* testRes_ ) { testRes = testRes_; }
+	static constexpr bool isFake() { return false; }
+	static constexpr bool supportsCrossThreadFree() { return true; }
+	CommonTestResults* testResults() { return testRes; }
+	void init( size_t threadID )
+	{
+		start = GetMillisecondCount();
+		testRes->threadID = threadID; // just as received
+		testRes->rdtscBegin = __rdtsc();
+	}
+
+	void* allocate( size_t sz ) { return new uint8_t[ sz ]; }
+	void deallocate( void* ptr ) { delete [] reinterpret_cast<uint8_t*>(ptr); }
+	size_t slowPathCount() const { return 0; } // unknown
+
+	void deinit() {}
+
+	// handing over the allocator (with all memory allocated by it) to another thread
+	void detachFromCurrentThread() {}
+	void attachToCurrentThread() {}
+
+	void doWhateverAfterSetupPhase() { testRes->rdtscSetup = __rdtsc(); }
+	void doWhateverWithinMainLoopPhase() {}
+	void doWhateverAfterMainLoopPhase() { testRes->rdtscMainLoop = __rdtsc(); }
+	void doWhateverAfterCleanupPhase()
+	{
+		testRes->rdtscExit = __rdtsc();
+		testRes->innerDur = GetMillisecondCount() - start;
+	}
+};
+
+class PerThreadAllocatorUnderTest
+{
+	ThreadLocalAllocatorT allocManager;
+	ThreadLocalAllocatorT* formerAlloc = nullptr;
+	ThreadTestRes* testRes;
+	size_t start;
+
+public:
+	PerThreadAllocatorUnderTest( ThreadTestRes* testRes_ ) { testRes = testRes_; }
+	static constexpr bool isFake() { return false; }
+	static constexpr bool supportsCrossThreadFree() { return false; } // memory must be deallocated by the allocator it was obtained from
+	CommonTestResults* testResults() { return testRes; }
+
+	void init( size_t threadID )
+	{
+		start = GetMillisecondCount();
+		testRes->rdtscBegin = __rdtsc();
+		allocManager.initialize();
+		formerAlloc = setCurrneAllocator( &allocManager );
+	}
+
+#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
+	void* allocate( size_t sz ) { 
+		void* ret = allocManager.zombieableAllocate( sz ); 
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, allocManager.isZombieablePointerInBlock(ret, ret)); 
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, !allocManager.isZombieablePointerInBlock(ret, nullptr)); 
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, sz == 0 || allocManager.isZombieablePointerInBlock(ret, reinterpret_cast<uint8_t*>(ret) + sz - 1)); 
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, sz < 16 || !allocManager.isZombieablePointerInBlock(ret, reinterpret_cast<uint8_t*>(ret) + sz*2)); 
+		return ret; 
+	}
+	void deallocate( void* ptr ) { allocManager.zombieableDeallocate( ptr ); }
+#else
+	void* allocate( size_t sz ) { 
+		void* ret = allocManager.allocate( sz ); 
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, allocManager.getAllocatedSize(ret) >= sz); 
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, sz < 8 || allocManager.getAllocatedSize(ret) <= sz*2); 
+		return ret; 
+	}
+	void deallocate( void* ptr ) { allocManager.deallocate( ptr ); }
+#endif
+	size_t slowPathCount() const { return allocManager.getSlowPathCount(); }
+	void deinit()
+	{
+#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
+		allocManager.killAllZombies();
+#endif
+		formerAlloc = setCurrneAllocator( formerAlloc );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, formerAlloc == &allocManager );
+	}
+
+	// handing over the allocator (with all memory allocated by it) to another thread; 
+	// at any given moment the allocator must be used by a single thread only
+	void detachFromCurrentThread()
+	{
+		formerAlloc = setCurrneAllocator( formerAlloc );
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, formerAlloc == &allocManager );
+		formerAlloc = nullptr;
+	}
+	void attachToCurrentThread() { formerAlloc = setCurrneAllocator( &allocManager ); }
+
+	void doWhateverAfterSetupPhase()
+	{
+#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
+		allocManager.killAllZombies();
+#endif
+		testRes->rdtscSetup = __rdtsc();
+		testRes->rdtscSysAllocCallSumAfterSetup = allocManager.getStats().rdtscSysAllocSpent;
+		testRes->sysAllocCallCntAfterSetup = allocManager.getStats().sysAllocCount;
+		testRes->rdtscSysDeallocCallSumAfterSetup = allocManager.getStats().rdtscSysDeallocSpent;
+		testRes->sysDeallocCallCntAfterSetup = allocManager.getStats().sysDeallocCount;
+		testRes->allocRequestCountAfterSetup = allocManager.getStats().allocRequestCount;
+		testRes->deallocRequestCountAfterSetup = allocManager.getStats().deallocRequestCount;
+		testRes->committedSizeAfterSetup = allocManager.getCommittedSize();
+	}
+
+	void doWhateverWithinMainLoopPhase()
+	{
+#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
+		allocManager.killAllZombies();
+#endif
+	}
+
+	void doWhateverAfterMainLoopPhase()
+	{
+#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
+		allocManager.killAllZombies();
+#endif
+		testRes->rdtscMainLoop = __rdtsc();
+		testRes->rdtscSysAllocCallSumAfterMainLoop = allocManager.getStats().rdtscSysAllocSpent;
+		testRes->sysAllocCallCntAfterMainLoop = allocManager.getStats().sysAllocCount;
+		testRes->rdtscSysDeallocCallSumAfterMainLoop = allocManager.getStats().rdtscSysDeallocSpent;
+		testRes->sysDeallocCallCntAfterMainLoop = allocManager.getStats().sysDeallocCount;
+		testRes->allocRequestCountAfterMainLoop = allocManager.getStats().allocRequestCount;
+		testRes->deallocRequestCountAfterMainLoop = allocManager.getStats().deallocRequestCount;
+		testRes->committedSizeAfterMainLoop = allocManager.getCommittedSize();
+	}
+
+	void doWhateverAfterCleanupPhase()
+	{
+#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
+		allocManager.killAllZombies();
+#endif
+		testRes->rdtscExit = __rdtsc();
+		testRes->rdtscSysAllocCallSumAfterExit = allocManager.getStats().rdtscSysAllocSpent;
+		testRes->sysAllocCallCntAfterExit = allocManager.getStats().sysAllocCount;
+		testRes->rdtscSysDeallocCallSumAfterExit = allocManager.getStats().rdtscSysDeallocSpent;
+		testRes->sysDeallocCallCntAfterExit = allocManager.getStats().sysDeallocCount;
+		testRes->allocRequestCountAfterExit = allocManager.getStats().allocRequestCount;
+		testRes->deallocRequestCountAfterExit = allocManager.getStats().deallocRequestCount;
+		testRes->committedSizeAfterExit = allocManager.getCommittedSize();
+		testRes->innerDur = GetMillisecondCount() - start;
+	}
+};
+
+// malloc()/free() of a malloc-compatible shared library (jemalloc, tcmalloc, mimalloc, etc) loaded at runtime;
+// to be loaded once, before any test thread is started
+class ExternalMallocLibrary
+{
+	using MallocFnT = void* (*)( size_t );
+	using FreeFnT = void (*)( void* );
+	void* handle = nullptr;
+	MallocFnT mallocFn = nullptr;
+	FreeFnT freeFn = nullptr;
+	const char* libPath = nullptr;
+
+	static ExternalMallocLibrary& instance() { static ExternalMallocLibrary lib; return lib; }
+
+public:
+	static bool load( const char* path )
+	{
+		ExternalMallocLibrary& lib = instance();
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, lib.handle == nullptr );
+#ifdef NODECPP_WINDOWS
+		HMODULE h = LoadLibraryA( path );
+		if ( h == nullptr )
+		{
+			nodecpp::log::default_log::info( "failed to load {} (error {})", path, GetLastError() );
+			return false;
+		}
+		lib.mallocFn = reinterpret_cast<MallocFnT>( GetProcAddress( h, "malloc" ) );
+		lib.freeFn = reinterpret_cast<FreeFnT>( GetProcAddress( h, "free" ) );
+		lib.handle = h;
+#else
+		// RTLD_LOCAL: symbols of the library are not used to resolve those of the test itself, so that new/delete remain intact
+		void* h = dlopen( path, RTLD_NOW | RTLD_LOCAL );
+		if ( h == nullptr )
+		{
+			nodecpp::log::default_log::info( "failed to load {} ({})", path, dlerror() );
+			return false;
+		}
+		lib.mallocFn = reinterpret_cast<MallocFnT>( dlsym( h, "malloc" ) );
+		lib.freeFn = reinterpret_cast<FreeFnT>( dlsym( h, "free" ) );
+		lib.handle = h;
+#endif
+		if ( lib.mallocFn == nullptr || lib.freeFn == nullptr )
+		{
+			nodecpp::log::default_log::info( "{} does not export malloc() and free()", path );
+			lib.mallocFn = nullptr;
+			lib.freeFn = nullptr;
+			return false;
+		}
+		lib.libPath = path;
+		return true;
+	}
+	static bool isLoaded() { return instance().mallocFn != nullptr; }
+	static const char* path() { return instance().libPath; }
+	static void* allocate( size_t sz ) { return instance().mallocFn( sz ); }
+	static void deallocate( void* ptr ) { instance().freeFn( ptr ); }
+};
+
+class ExternalMallocUnderTest
+{
+	CommonTestResults* testRes;
+	size_t start;
+
+public:
+	ExternalMallocUnderTest( CommonTestResults* testRes_ ) { testRes = testRes_; NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ExternalMallocLibrary::isLoaded() ); }
+	static constexpr bool isFake() { return false; }
+	static constexpr bool supportsCrossThreadFree() { return true; }
+	CommonTestResults* testResults() { return testRes; }
+	void init( size_t threadID )
+	{
+		start = GetMillisecondCount();
+		testRes->threadID = threadID; // just as received
+		testRes->rdtscBegin = __rdtsc();
+	}
+
+	void* allocate( size_t sz ) { return ExternalMallocLibrary::allocate( sz ); }
+	void deallocate( void* ptr ) { ExternalMallocLibrary::deallocate( ptr ); }
+	size_t slowPathCount() const { return 0; } // unknown
+
+	void deinit() {}
+
+	void detachFromCurrentThread() {}
+	void attachToCurrentThread() {}
+
+	void doWhateverAfterSetupPhase() { testRes->rdtscSetup = __rdtsc(); }
+	void doWhateverWithinMainLoopPhase() {}
+	void doWhateverAfterMainLoopPhase() { testRes->rdtscMainLoop = __rdtsc(); }
+	void doWhateverAfterCleanupPhase()
+	{
+		testRes->rdtscExit = __rdtsc();
+		testRes->innerDur = GetMillisecondCount() - start;
+	}
+};
+
+class FakeAllocatorUnderTest
+{
+	CommonTestResults* testRes;
+	size_t start;
+	uint8_t* fakeBuffer = nullptr;
+	static constexpr size_t fakeBufferSize = 0x1000000;
+
+public:
+	FakeAllocatorUnderTest( CommonTestResults* testRes_ ) { testRes = testRes_; }
+	static constexpr bool isFake() { return true; } // thus indicating that certain checks over allocated memory should be ommited
+	static constexpr bool supportsCrossThreadFree() { return true; }
+	CommonTestResults* testResults() { return testRes; }
+
+	void init( size_t threadID )
+	{
+		start = GetMillisecondCount();
+		testRes->threadID = threadID; // just as received
+		testRes->rdtscBegin = __rdtsc();
+		fakeBuffer = new uint8_t [fakeBufferSize];
+	}
+
+	void* allocate( size_t sz ) { NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, sz <= fakeBufferSize ); return fakeBuffer; }
+	void deallocate( void* ptr ) {}
+	size_t slowPathCount() const { return 0; }
+
+	void deinit() { if ( fakeBuffer ) delete [] fakeBuffer; fakeBuffer = nullptr; }
+
+	void detachFromCurrentThread() {}
+	void attachToCurrentThread() {}
+
+	void doWhateverAfterSetupPhase() { testRes->rdtscSetup = __rdtsc(); }
+	void doWhateverWithinMainLoopPhase() {}
+	void doWhateverAfterMainLoopPhase() { testRes->rdtscMainLoop = __rdtsc(); }
+	void doWhateverAfterCleanupPhase()
+	{
+		testRes->rdtscExit = __rdtsc();
+		testRes->innerDur = GetMillisecondCount() - start;
+	}
+};
+
+#endif // ALLOCATOR_UNDER_TEST_H
@@ -0,0 +1,193 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * 
+ * Per-thread bucket allocator
+ * Fragmentation of BulkAllocator (chunks of 3 to 32 pages, that is, above MaxBucketSize and up to the bulk allocator limit): 
+ *     random replacement of live chunks with size distributions that change over time, 
+ *     reports memory committed vs. memory held by live chunks (at the end of each phase and at peak), and throughput
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "test_common.h"
+
+#include <memory>
+#include <cstring>
+
+struct BulkFragmentationPhase
+{
+	size_t minPages;
+	size_t maxPages;
+	size_t smallShare; // percentage of sizes taken from [minPages, minPages + 1] rather than [minPages, maxPages]
+};
+
+struct BulkFragmentationConfig
+{
+	const char* name;
+	size_t slotCount; // max number of live chunks
+	BulkFragmentationPhase phases[3]; // run one after another for bulk_fragmentation_ops_per_phase operations each
+};
+
+struct BulkFragmentationResult
+{
+	size_t dur;
+	uint64_t opCount;
+	size_t liveSizeAtPhaseEnd[3]; // sum of allocated sizes of live chunks
+	size_t committedAtPhaseEnd[3];
+	size_t peakCommitted;
+	size_t peakLiveSize;
+};
+
+constexpr size_t bulk_fragmentation_ops_per_phase = 1000000;
+constexpr size_t bulk_fragmentation_sample_every = 1000; // operations between committed size samples
+
+NODECPP_FORCEINLINE uint32_t bulkFragmentationRandom( uint32_t& x )
+{
+	/* Algorithm "xor" from p. 4 of Marsaglia, "Xorshift RNGs" */
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+// size that results in a bulk chunk of exactly 'pages' pages (including the chunk header)
+NODECPP_FORCEINLINE size_t bulkFragmentationSize( size_t pages, uint32_t r )
+{
+	return ( pages << PAGE_SIZE_EXP ) - 64 - r % ( PAGE_SIZE_BYTES / 2 );
+}
+
+void runBulkFragmentationBenchmark( const BulkFragmentationConfig& config, BulkFragmentationResult& res )
+{
+	struct Slot
+	{
+		uint8_t* ptr;
+		size_t allocatedSize;
+	};
+	std::unique_ptr<IibAllocatorBase> allocator( new IibAllocatorBase );
+	std::unique_ptr<Slot[]> slots( new Slot[ config.slotCount ] );
+	memset( slots.get(), 0, sizeof( Slot ) * config.slotCount );
+	uint32_t rng = 0x12345678;
+	size_t liveSize = 0;
+	res.peakCommitted = 0;
+	res.peakLiveSize = 0;
+
+	size_t start = GetMillisecondCount();
+	for ( size_t phase=0; phase<3; ++phase )
+	{
+		const BulkFragmentationPhase& p = config.phases[phase];
+		for ( size_t i=0; i<bulk_fragmentation_ops_per_phase; ++i )
+		{
+			uint32_t r = bulkFragmentationRandom( rng );
+			Slot& slot = slots[ r % config.slotCount ];
+			if ( slot.ptr )
+			{
+				liveSize -= slot.allocatedSize;
+				allocator->deallocate( slot.ptr );
+				slot.ptr = nullptr;
+			}
+			else
+			{
+				r = bulkFragmentationRandom( rng );
+				size_t pages = r % 100 < p.smallShare ? p.minPages + ( r >> 8 ) % 2 : p.minPages + ( r >> 8 ) % ( p.maxPages - p.minPages + 1 );
+				size_t sz = bulkFragmentationSize( pages, r >> 16 );
+				slot.ptr = reinterpret_cast<uint8_t*>( allocator->allocate( sz ) );
+				for ( size_t off=0; off<sz; off+=PAGE_SIZE_BYTES ) // each page is touched, otherwise page faults (and thus time) depend on which pages happen to hold chunk headers
+					slot.ptr[off] = (uint8_t)i;
+				slot.allocatedSize = allocator->getAllocatedSize( slot.ptr );
+				liveSize += slot.allocatedSize;
+			}
+			++(res.opCount);
+
+			if ( i % bulk_fragmentation_sample_every == 0 )
+			{
+				size_t committed = allocator->getCommittedSize();
+				if ( committed > res.peakCommitted )
+					res.peakCommitted = committed;
+				if ( liveSize > res.peakLiveSize )
+					res.peakLiveSize = liveSize;
+			}
+		}
+		res.liveSizeAtPhaseEnd[phase] = liveSize;
+		res.committedAtPhaseEnd[phase] = allocator->getCommittedSize();
+	}
+	res.dur = GetMillisecondCount() - start;
+
+	for ( size_t i=0; i<config.slotCount; ++i )
+		if ( slots[i].ptr )
+			allocator->deallocate( slots[i].ptr );
+}
+
+NODECPP_FORCEINLINE double bulkFragmentationRatio( size_t committed, size_t live ) { return live ? committed * 1. / live : 0.; }
+
+void printBulkFragmentationResult( const BulkFragmentationConfig& config, const BulkFragmentationResult& res )
+{
+	double opsPerSec = res.dur ? res.opCount * 1000. / res.dur : 0;
+	nodecpp::log::default_log::info( "{}: {} ops in {} ms, {:.0f} ops/s; committed/live at phase ends: {} / {} KB ({:.2f}), {} / {} KB ({:.2f}), {} / {} KB ({:.2f}); peak committed {} KB, peak live {} KB", 
+		config.name, res.opCount, res.dur, opsPerSec,
+		res.committedAtPhaseEnd[0] >> 10, res.liveSizeAtPhaseEnd[0] >> 10, bulkFragmentationRatio( res.committedAtPhaseEnd[0], res.liveSizeAtPhaseEnd[0] ),
+		res.committedAtPhaseEnd[1] >> 10, res.liveSizeAtPhaseEnd[1] >> 10, bulkFragmentationRatio( res.committedAtPhaseEnd[1], res.liveSizeAtPhaseEnd[1] ),
+		res.committedAtPhaseEnd[2] >> 10, res.liveSizeAtPhaseEnd[2] >> 10, bulkFragmentationRatio( res.committedAtPhaseEnd[2], res.liveSizeAtPhaseEnd[2] ),
+		res.peakCommitted >> 10, res.peakLiveSize >> 10 );
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	log.level = nodecpp::log::LogLevel::info;
+	log.add( stdout );
+	nodecpp::logging_impl::currentLog = &log;
+
+	BulkFragmentationConfig configs[] = {
+		{ "uniform 3..32 pages", 2000, { { 3, 32, 0 }, { 3, 32, 0 }, { 3, 32, 0 } } },
+		{ "mostly 3..4 pages, some up to 32", 4000, { { 3, 32, 80 }, { 3, 32, 80 }, { 3, 32, 80 } } },
+		{ "small (3..8 pages), then large (16..32), then mixed", 4000, { { 3, 8, 0 }, { 16, 32, 0 }, { 3, 32, 50 } } },
+		{ "large (16..32 pages), then small (3..8), then large again", 2000, { { 16, 32, 0 }, { 3, 8, 0 }, { 16, 32, 0 } } },
+	};
+	constexpr size_t configCount = sizeof( configs ) / sizeof( configs[0] );
+
+	std::unique_ptr<BulkFragmentationResult[]> results( new BulkFragmentationResult[ configCount ]() );
+	for ( size_t i=0; i<configCount; ++i )
+	{
+		runBulkFragmentationBenchmark( configs[i], results[i] );
+		printBulkFragmentationResult( configs[i], results[i] );
+	}
+
+	nodecpp::log::default_log::info( "" );
+	nodecpp::log::default_log::info( "Short summary (configuration, ops/s, committed/live at the end of each phase, peak committed KB, peak live KB):" );
+	for ( size_t i=0; i<configCount; ++i )
+	{
+		const BulkFragmentationResult& res = results[i];
+		double opsPerSec = res.dur ? res.opCount * 1000. / res.dur : 0;
+		nodecpp::log::default_log::info( "{},{:.0f},{:.2f},{:.2f},{:.2f},{},{}", configs[i].name, opsPerSec, 
+			bulkFragmentationRatio( res.committedAtPhaseEnd[0], res.liveSizeAtPhaseEnd[0] ), bulkFragmentationRatio( res.committedAtPhaseEnd[1], res.liveSizeAtPhaseEnd[1] ), bulkFragmentationRatio( res.committedAtPhaseEnd[2], res.liveSizeAtPhaseEnd[2] ),
+			res.peakCommitted >> 10, res.peakLiveSize >> 10 );
+	}
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
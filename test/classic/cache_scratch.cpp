@@ -0,0 +1,153 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * cache-scratch (after the Hoard benchmark suite): detects passive false sharing, that is, 
+ *     allocators reusing, in different threads, memory that shares cache lines with objects 
+ *     handed out to them by another thread
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "classic_common.h"
+
+// Cross-thread frees: required by the original benchmark, where the main thread allocates an object per worker,
+// and each worker starts with deallocating it. With an allocator that supports cross-thread frees this is done as is.
+// Otherwise (iibmalloc) the worker keeps writing to the object it got from the main thread along with its own ones, 
+// and the objects are returned to the main thread to be deallocated after all workers are done. 
+// Passive false sharing through reuse of such objects is therefore impossible by design; 
+// what remains measured is whether own allocations of workers share cache lines with objects of other threads.
+
+struct CacheScratchParams
+{
+	size_t iterations;
+	size_t objSize;
+	size_t repetitions; // number of times each byte of an object is written to
+};
+
+NODECPP_FORCEINLINE void scratchObject( volatile uint8_t* obj, const CacheScratchParams& params )
+{
+	for ( size_t j=0; j<params.repetitions; ++j )
+		for ( size_t k=0; k<params.objSize; ++k )
+			obj[k] = (uint8_t)( obj[k] + 1 );
+}
+
+template< class AllocatorUnderTest>
+void cacheScratchThread( AllocatorUnderTest& allocatorUnderTest, const CacheScratchParams& params, size_t threadID, uint8_t* handedObj, ClassicThreadRes& res )
+{
+	allocatorUnderTest.init( threadID );
+	allocatorUnderTest.doWhateverAfterSetupPhase();
+	scratchObject( handedObj, params );
+	if constexpr ( AllocatorUnderTest::supportsCrossThreadFree() )
+	{
+		allocatorUnderTest.deallocate( handedObj );
+		++(res.opCount);
+	}
+	for ( size_t i=0; i<params.iterations; ++i )
+	{
+		volatile uint8_t* obj = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( params.objSize ) );
+		scratchObject( obj, params );
+		if constexpr ( !AllocatorUnderTest::supportsCrossThreadFree() )
+			scratchObject( handedObj, params );
+		res.dummyCtr += obj[0];
+		allocatorUnderTest.deallocate( const_cast<uint8_t*>( obj ) );
+		res.opCount += 2;
+	}
+	allocatorUnderTest.doWhateverAfterMainLoopPhase();
+	allocatorUnderTest.deinit();
+	allocatorUnderTest.doWhateverAfterCleanupPhase();
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	initClassicBenchmarkLog( log );
+	printClassicBenchmarkHeader( "cache-scratch", true, "with the per-thread allocator objects handed out by the main thread are deallocated by it after workers are done; see cache_scratch.cpp" );
+
+	CacheScratchParams params;
+	params.iterations = 100000;
+	params.objSize = 8;
+	params.repetitions = 100;
+
+	size_t threadCounts[] = { 1, 2, 4 };
+	constexpr size_t threadCountsSize = sizeof( threadCounts ) / sizeof( threadCounts[0] );
+	ClassicThreadRes* res = new ClassicThreadRes[ classic_max_threads + 1 ]; // last one is for the main thread
+	ClassicRunSummary summary[ threadCountsSize ];
+
+	for ( size_t i=0; i<threadCountsSize; ++i )
+	{
+		summary[i].threadCount = threadCounts[i];
+		for ( size_t allocatorType : { (size_t)USE_NEW_DELETE, (size_t)USE_PER_THREAD_ALLOCATOR } )
+		{
+			memset( res, 0, sizeof( ClassicThreadRes ) * ( classic_max_threads + 1 ) );
+			size_t dur = 0;
+			runWithAllocatorUnderTest( allocatorType, &(res[classic_max_threads].allocatorRes), [&]( auto& mainAllocator ) {
+				using AllocatorUnderTest = std::remove_reference_t<decltype( mainAllocator )>;
+				uint8_t* handedObjs[ classic_max_threads ];
+				mainAllocator.init( classic_max_threads );
+				for ( size_t j=0; j<threadCounts[i]; ++j )
+					handedObjs[j] = reinterpret_cast<uint8_t*>( mainAllocator.allocate( params.objSize ) );
+				mainAllocator.doWhateverAfterSetupPhase();
+
+				// thread state objects are allocated by the spawning thread and deallocated by the spawned one
+				mainAllocator.detachFromCurrentThread();
+				dur = runClassicThreads( threadCounts[i], [&]( size_t threadID ) {
+					AllocatorUnderTest allocator( &(res[threadID].allocatorRes) );
+					cacheScratchThread( allocator, params, threadID, handedObjs[threadID], res[threadID] );
+				} );
+				mainAllocator.attachToCurrentThread();
+
+				if constexpr ( !AllocatorUnderTest::supportsCrossThreadFree() )
+				{
+					for ( size_t j=0; j<threadCounts[i]; ++j )
+						mainAllocator.deallocate( handedObjs[j] );
+				}
+				mainAllocator.doWhateverAfterMainLoopPhase();
+				mainAllocator.deinit();
+				mainAllocator.doWhateverAfterCleanupPhase();
+			} );
+			uint64_t dummyCtr = 0;
+			uint64_t opCount = sumClassicOpCount( res, threadCounts[i], &dummyCtr );
+			printClassicBenchmarkResult( "cache-scratch", allocatorType, threadCounts[i], opCount, dur, dummyCtr );
+			if ( allocatorType == USE_NEW_DELETE )
+			{
+				summary[i].durNewDel = dur;
+				summary[i].opCountNewDel = opCount;
+			}
+			else
+			{
+				summary[i].durPerThread = dur;
+				summary[i].opCountPerThread = opCount;
+			}
+		}
+	}
+	printClassicBenchmarkSummary( "cache-scratch", summary, threadCountsSize );
+	delete [] res;
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
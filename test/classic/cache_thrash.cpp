@@ -0,0 +1,82 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * cache-thrash (after the Hoard benchmark suite): detects active false sharing, that is, 
+ *     allocators handing out parts of the same cache line to different threads
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "classic_common.h"
+
+// Cross-thread frees: not required; each thread deallocates only what it has allocated
+
+struct CacheThrashParams
+{
+	size_t iterations;
+	size_t objSize;
+	size_t repetitions; // number of times each byte of an object is written to
+};
+
+template< class AllocatorUnderTest>
+void cacheThrashThread( AllocatorUnderTest& allocatorUnderTest, const CacheThrashParams& params, size_t threadID, ClassicThreadRes& res )
+{
+	allocatorUnderTest.init( threadID );
+	allocatorUnderTest.doWhateverAfterSetupPhase();
+	for ( size_t i=0; i<params.iterations; ++i )
+	{
+		volatile uint8_t* obj = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( params.objSize ) );
+		for ( size_t j=0; j<params.repetitions; ++j )
+			for ( size_t k=0; k<params.objSize; ++k )
+				obj[k] = (uint8_t)( obj[k] + 1 );
+		res.dummyCtr += obj[0];
+		allocatorUnderTest.deallocate( const_cast<uint8_t*>( obj ) );
+		res.opCount += 2;
+	}
+	allocatorUnderTest.doWhateverAfterMainLoopPhase();
+	allocatorUnderTest.deinit();
+	allocatorUnderTest.doWhateverAfterCleanupPhase();
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	initClassicBenchmarkLog( log );
+	printClassicBenchmarkHeader( "cache-thrash", false, nullptr );
+
+	CacheThrashParams params;
+	params.iterations = 100000;
+	params.objSize = 8;
+	params.repetitions = 100;
+
+	size_t threadCounts[] = { 1, 2, 4 };
+	runClassicPerThreadBenchmark( "cache-thrash", threadCounts, sizeof( threadCounts ) / sizeof( threadCounts[0] ), [&]( auto& allocator, size_t threadID, ClassicThreadRes& res ) { cacheThrashThread( allocator, params, threadID, res ); } );
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
@@ -0,0 +1,205 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Common infrastructure for ports of classic allocator benchmarks
+ * 
+ * -------------------------------------------------------------------------------*/
+#ifndef CLASSIC_COMMON_H
+#define CLASSIC_COMMON_H
+
+#include "../allocator_under_test.h"
+
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// Each benchmark states whether its original form frees memory in a thread other than the one that has allocated it.
+// As iibmalloc does not support it (see PerThreadAllocatorUnderTest::supportsCrossThreadFree()), such benchmarks
+// describe how they are adapted (see printClassicBenchmarkHeader() calls)
+
+constexpr size_t classic_max_threads = 64;
+
+struct ClassicThreadRes
+{
+	ThreadTestRes allocatorRes;
+	uint64_t opCount; // allocations plus deallocations
+	uint64_t dummyCtr;
+};
+
+struct ClassicRunSummary
+{
+	size_t threadCount;
+	size_t durNewDel;
+	uint64_t opCountNewDel;
+	size_t durPerThread;
+	uint64_t opCountPerThread;
+};
+
+NODECPP_FORCEINLINE uint32_t classicRandom( uint32_t& x )
+{
+	/* Algorithm "xor" from p. 4 of Marsaglia, "Xorshift RNGs" */
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+NODECPP_FORCEINLINE uint32_t classicSeed( size_t threadID, size_t round = 0 )
+{
+	uint32_t ret = (uint32_t)( ( threadID + 1 ) * 2654435761u ) ^ (uint32_t)( ( round + 1 ) * 0x9E3779B9u );
+	return ret ? ret : 1;
+}
+
+inline const char* allocatorName( size_t allocatorType )
+{
+	switch ( allocatorType )
+	{
+		case USE_PER_THREAD_ALLOCATOR: return "per-thread allocator";
+		case USE_NEW_DELETE: return "new/delete";
+		case USE_EMPTY_TEST: return "empty test";
+		default: return "unknown";
+	}
+}
+
+inline void printClassicBenchmarkHeader( const char* name, bool needsCrossThreadFree, const char* adaptationNote )
+{
+	nodecpp::log::default_log::info( "{}: cross-thread frees are {}required by the original benchmark", name, needsCrossThreadFree ? "" : "not " );
+	if ( adaptationNote != nullptr )
+		nodecpp::log::default_log::info( "    {}", adaptationNote );
+}
+
+// calls fn( allocatorUnderTest ) with an allocator of the type requested; testRes must outlive the call
+template<class Fn>
+void runWithAllocatorUnderTest( size_t allocatorType, ThreadTestRes* testRes, Fn&& fn )
+{
+	switch ( allocatorType )
+	{
+		case USE_PER_THREAD_ALLOCATOR:
+		{
+			PerThreadAllocatorUnderTest allocator( testRes );
+			fn( allocator );
+			break;
+		}
+		case USE_NEW_DELETE:
+		{
+			NewDeleteUnderTest allocator( testRes );
+			fn( allocator );
+			break;
+		}
+		default:
+			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, false );
+	}
+}
+
+// runs fn( threadID ) in threadCount threads and returns the time elapsed, in ms
+template<class Fn>
+size_t runClassicThreads( size_t threadCount, Fn&& fn )
+{
+	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, threadCount <= classic_max_threads );
+	std::thread threads[ classic_max_threads ];
+	size_t start = GetMillisecondCount();
+	for ( size_t i=0; i<threadCount; ++i )
+		threads[i] = std::thread( std::ref( fn ), i );
+	for ( size_t i=0; i<threadCount; ++i )
+		threads[i].join();
+	return GetMillisecondCount() - start;
+}
+
+inline uint64_t sumClassicOpCount( const ClassicThreadRes* res, size_t threadCount, uint64_t* dummyCtr = nullptr )
+{
+	uint64_t ret = 0;
+	for ( size_t i=0; i<threadCount; ++i )
+	{
+		ret += res[i].opCount;
+		if ( dummyCtr )
+			*dummyCtr += res[i].dummyCtr;
+	}
+	return ret;
+}
+
+inline void printClassicBenchmarkResult( const char* name, size_t allocatorType, size_t threadCount, uint64_t opCount, size_t dur, uint64_t dummyCtr )
+{
+	nodecpp::log::default_log::info( "{} using {}: {} thread(s), {} ops in {} ms, {:.0f} ops/s [ctr = {}]", name, allocatorName( allocatorType ), threadCount, opCount, dur, dur ? opCount * 1000. / dur : 0., dummyCtr );
+}
+
+inline void printClassicBenchmarkSummary( const char* name, const ClassicRunSummary* summary, size_t cnt )
+{
+	nodecpp::log::default_log::info( "" );
+	nodecpp::log::default_log::info( "Short summary for {} (threads, ops/s new/delete, ops/s per-thread, per-thread to new/delete ratio):", name );
+	for ( size_t i=0; i<cnt; ++i )
+	{
+		double newDel = summary[i].durNewDel ? summary[i].opCountNewDel * 1000. / summary[i].durNewDel : 0.;
+		double perThread = summary[i].durPerThread ? summary[i].opCountPerThread * 1000. / summary[i].durPerThread : 0.;
+		nodecpp::log::default_log::info( "{},{:.0f},{:.0f},{:.2f}", summary[i].threadCount, newDel, perThread, newDel ? perThread / newDel : 0. );
+	}
+}
+
+// for benchmarks in which each thread uses its own allocator only: 
+// runs threadFn( allocatorUnderTest, threadID, threadRes ) in each of threadCounts[i] threads, for each allocator type, and prints the results
+template<class ThreadFn>
+void runClassicPerThreadBenchmark( const char* name, const size_t* threadCounts, size_t cnt, ThreadFn&& threadFn )
+{
+	ClassicThreadRes* res = new ClassicThreadRes[ classic_max_threads ];
+	ClassicRunSummary* summary = new ClassicRunSummary[ cnt ];
+	for ( size_t i=0; i<cnt; ++i )
+	{
+		summary[i].threadCount = threadCounts[i];
+		for ( size_t allocatorType : { (size_t)USE_NEW_DELETE, (size_t)USE_PER_THREAD_ALLOCATOR } )
+		{
+			memset( res, 0, sizeof( ClassicThreadRes ) * classic_max_threads );
+			size_t dur = runClassicThreads( threadCounts[i], [&]( size_t threadID ) {
+				runWithAllocatorUnderTest( allocatorType, &(res[threadID].allocatorRes), [&]( auto& allocator ) { threadFn( allocator, threadID, res[threadID] ); } );
+			} );
+			uint64_t dummyCtr = 0;
+			uint64_t opCount = sumClassicOpCount( res, threadCounts[i], &dummyCtr );
+			printClassicBenchmarkResult( name, allocatorType, threadCounts[i], opCount, dur, dummyCtr );
+			if ( allocatorType == USE_NEW_DELETE )
+			{
+				summary[i].durNewDel = dur;
+				summary[i].opCountNewDel = opCount;
+			}
+			else
+			{
+				summary[i].durPerThread = dur;
+				summary[i].opCountPerThread = opCount;
+			}
+		}
+	}
+	printClassicBenchmarkSummary( name, summary, cnt );
+	delete [] summary;
+	delete [] res;
+}
+
+inline void initClassicBenchmarkLog( nodecpp::log::Log& log )
+{
+	log.level = nodecpp::log::LogLevel::info;
+	log.add( stdout );
+	nodecpp::logging_impl::currentLog = &log;
+}
+
+#endif // CLASSIC_COMMON_H
@@ -0,0 +1,170 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * larson (after Larson and Krishnan, "Memory allocation for long-running server applications"): 
+ *     each thread replaces random objects in its own array, and then hands the array over 
+ *     to a new thread, which keeps working on it
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "classic_common.h"
+
+// Cross-thread frees: required by the original benchmark, as objects allocated by one thread are deallocated by its successor.
+// With an allocator that supports cross-thread frees this is done as is. Otherwise (iibmalloc) the allocator is handed over 
+// to the successor along with the objects (see detachFromCurrentThread()/attachToCurrentThread()), that is, 
+// it is the heap that migrates between threads, as it would be with (Re)Actors moved between threads. 
+// Unlike the original, threads of each round are started together after all threads of the previous round have exited.
+
+struct LarsonParams
+{
+	size_t threadCount;
+	size_t rounds;
+	size_t iterationsPerRound;
+	size_t slotsPerThread;
+	size_t minObjSize;
+	size_t maxObjSize;
+};
+
+template< class AllocatorUnderTest>
+struct LarsonLane
+{
+	AllocatorUnderTest allocator;
+	uint8_t** slots = nullptr;
+	LarsonLane( ThreadTestRes* testRes ) : allocator( testRes ) {}
+};
+
+template< class AllocatorUnderTest>
+NODECPP_FORCEINLINE uint8_t* larsonAllocate( AllocatorUnderTest& allocatorUnderTest, const LarsonParams& params, uint32_t& rng )
+{
+	size_t sz = params.minObjSize + classicRandom( rng ) % ( params.maxObjSize - params.minObjSize + 1 );
+	uint8_t* ret = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( sz ) );
+	ret[0] = (uint8_t)sz;
+	ret[sz - 1] = (uint8_t)sz;
+	return ret;
+}
+
+template< class AllocatorUnderTest>
+void larsonRound( LarsonLane<AllocatorUnderTest>& lane, const LarsonParams& params, size_t laneID, size_t round, ClassicThreadRes& res )
+{
+	AllocatorUnderTest& allocatorUnderTest = lane.allocator;
+	uint32_t rng = classicSeed( laneID, round );
+	if ( round == 0 )
+	{
+		allocatorUnderTest.init( laneID );
+		lane.slots = reinterpret_cast<uint8_t**>( allocatorUnderTest.allocate( sizeof( uint8_t* ) * params.slotsPerThread ) );
+		for ( size_t i=0; i<params.slotsPerThread; ++i )
+			lane.slots[i] = larsonAllocate( allocatorUnderTest, params, rng );
+		allocatorUnderTest.doWhateverAfterSetupPhase();
+	}
+	else
+		allocatorUnderTest.attachToCurrentThread();
+
+	for ( size_t i=0; i<params.iterationsPerRound; ++i )
+	{
+		size_t idx = classicRandom( rng ) % params.slotsPerThread;
+		res.dummyCtr += lane.slots[idx][0];
+		allocatorUnderTest.deallocate( lane.slots[idx] );
+		lane.slots[idx] = larsonAllocate( allocatorUnderTest, params, rng );
+		res.opCount += 2;
+		if ( ( i & 0xFFFF ) == 0xFFFF )
+			allocatorUnderTest.doWhateverWithinMainLoopPhase();
+	}
+
+	if ( round == params.rounds - 1 )
+	{
+		allocatorUnderTest.doWhateverAfterMainLoopPhase();
+		for ( size_t i=0; i<params.slotsPerThread; ++i )
+			allocatorUnderTest.deallocate( lane.slots[i] );
+		allocatorUnderTest.deallocate( lane.slots );
+		lane.slots = nullptr;
+		allocatorUnderTest.deinit();
+		allocatorUnderTest.doWhateverAfterCleanupPhase();
+	}
+	else
+		allocatorUnderTest.detachFromCurrentThread();
+}
+
+// returns the time elapsed, in ms
+template< class AllocatorUnderTest>
+size_t runLarson( const LarsonParams& params, ClassicThreadRes* res )
+{
+	LarsonLane<AllocatorUnderTest>* lanes[ classic_max_threads ];
+	for ( size_t i=0; i<params.threadCount; ++i )
+		lanes[i] = new LarsonLane<AllocatorUnderTest>( &(res[i].allocatorRes) );
+
+	size_t dur = 0;
+	for ( size_t round=0; round<params.rounds; ++round )
+		dur += runClassicThreads( params.threadCount, [&]( size_t threadID ) { larsonRound( *(lanes[threadID]), params, threadID, round, res[threadID] ); } );
+
+	for ( size_t i=0; i<params.threadCount; ++i )
+		delete lanes[i];
+	return dur;
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	initClassicBenchmarkLog( log );
+	printClassicBenchmarkHeader( "larson", true, "with the per-thread allocator the heap migrates to the successor thread along with objects; see larson.cpp" );
+
+	LarsonParams params;
+	params.rounds = 10;
+	params.iterationsPerRound = 50000;
+	params.slotsPerThread = 5000;
+	params.minObjSize = 8;
+	params.maxObjSize = 1000;
+
+	size_t threadCounts[] = { 1, 2, 4 };
+	constexpr size_t threadCountsSize = sizeof( threadCounts ) / sizeof( threadCounts[0] );
+	ClassicThreadRes* res = new ClassicThreadRes[ classic_max_threads ];
+	ClassicRunSummary summary[ threadCountsSize ];
+
+	for ( size_t i=0; i<threadCountsSize; ++i )
+	{
+		params.threadCount = threadCounts[i];
+		summary[i].threadCount = threadCounts[i];
+
+		memset( res, 0, sizeof( ClassicThreadRes ) * classic_max_threads );
+		summary[i].durNewDel = runLarson<NewDeleteUnderTest>( params, res );
+		uint64_t dummyCtr = 0;
+		summary[i].opCountNewDel = sumClassicOpCount( res, params.threadCount, &dummyCtr );
+		printClassicBenchmarkResult( "larson", USE_NEW_DELETE, params.threadCount, summary[i].opCountNewDel, summary[i].durNewDel, dummyCtr );
+
+		memset( res, 0, sizeof( ClassicThreadRes ) * classic_max_threads );
+		summary[i].durPerThread = runLarson<PerThreadAllocatorUnderTest>( params, res );
+		dummyCtr = 0;
+		summary[i].opCountPerThread = sumClassicOpCount( res, params.threadCount, &dummyCtr );
+		printClassicBenchmarkResult( "larson", USE_PER_THREAD_ALLOCATOR, params.threadCount, summary[i].opCountPerThread, summary[i].durPerThread, dummyCtr );
+	}
+	printClassicBenchmarkSummary( "larson", summary, threadCountsSize );
+	delete [] res;
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
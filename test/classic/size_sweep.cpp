@@ -0,0 +1,126 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Size sweep (after glibc benchtests/bench-malloc-thread): each thread keeps a working set 
+ *     of blocks and replaces random ones with blocks of random sizes, the size distribution 
+ *     being inversely proportional to the size; repeated for a range of maximum block sizes
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "classic_common.h"
+
+// Cross-thread frees: not required; each thread deallocates only what it has allocated
+
+constexpr size_t size_sweep_block_sizes_count = 0x2000; // power of 2
+
+struct SizeSweepParams
+{
+	size_t iterations;
+	size_t workingSetSize; // power of 2
+	size_t minSize;
+	size_t maxSize;
+	size_t blockSizes[ size_sweep_block_sizes_count ];
+
+	// as in glibc: probability of a size is inversely proportional to the size
+	void initBlockSizes()
+	{
+		double minInv = 1. / minSize;
+		double maxInv = 1. / maxSize;
+		for ( size_t i=0; i<size_sweep_block_sizes_count; ++i )
+		{
+			double frac = ( i + 0.5 ) / size_sweep_block_sizes_count;
+			blockSizes[i] = (size_t)( 1. / ( minInv - frac * ( minInv - maxInv ) ) );
+		}
+	}
+};
+
+template< class AllocatorUnderTest>
+void sizeSweepThread( AllocatorUnderTest& allocatorUnderTest, const SizeSweepParams& params, size_t threadID, ClassicThreadRes& res )
+{
+	allocatorUnderTest.init( threadID );
+	uint32_t rng = classicSeed( threadID );
+	void** workingSet = reinterpret_cast<void**>( allocatorUnderTest.allocate( sizeof( void* ) * params.workingSetSize ) );
+	memset( workingSet, 0, sizeof( void* ) * params.workingSetSize );
+	allocatorUnderTest.doWhateverAfterSetupPhase();
+
+	for ( size_t i=0; i<params.iterations; ++i )
+	{
+		uint32_t r = classicRandom( rng );
+		size_t idx = r & ( params.workingSetSize - 1 );
+		size_t sz = params.blockSizes[ ( r >> 16 ) & ( size_sweep_block_sizes_count - 1 ) ];
+		if ( workingSet[idx] )
+		{
+			allocatorUnderTest.deallocate( workingSet[idx] );
+			++(res.opCount);
+		}
+		uint8_t* block = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( sz ) );
+		block[0] = (uint8_t)i;
+		workingSet[idx] = block;
+		++(res.opCount);
+		if ( ( i & 0xFFFF ) == 0xFFFF )
+			allocatorUnderTest.doWhateverWithinMainLoopPhase();
+	}
+
+	allocatorUnderTest.doWhateverAfterMainLoopPhase();
+	for ( size_t i=0; i<params.workingSetSize; ++i )
+		if ( workingSet[i] )
+		{
+			res.dummyCtr += *reinterpret_cast<uint8_t*>( workingSet[i] );
+			allocatorUnderTest.deallocate( workingSet[i] );
+		}
+	allocatorUnderTest.deallocate( workingSet );
+	allocatorUnderTest.deinit();
+	allocatorUnderTest.doWhateverAfterCleanupPhase();
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	initClassicBenchmarkLog( log );
+	printClassicBenchmarkHeader( "size-sweep", false, nullptr );
+
+	SizeSweepParams* params = new SizeSweepParams;
+	params->iterations = 1000000;
+	params->workingSetSize = 1024;
+	params->minSize = 4;
+
+	size_t threadCounts[] = { 1, 2 };
+	char name[ 64 ];
+	for ( size_t maxSize : { 64, 256, 1024, 4096, 16384, 65536, 262144 } )
+	{
+		params->maxSize = maxSize;
+		params->initBlockSizes();
+		snprintf( name, sizeof( name ), "size-sweep [%zd..%zd]", params->minSize, params->maxSize );
+		runClassicPerThreadBenchmark( name, threadCounts, sizeof( threadCounts ) / sizeof( threadCounts[0] ), [&]( auto& allocator, size_t threadID, ClassicThreadRes& res ) { sizeSweepThread( allocator, *params, threadID, res ); } );
+	}
+	delete params;
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
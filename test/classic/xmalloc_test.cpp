@@ -0,0 +1,100 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * xmalloc-test, per-thread variant: batches of objects of random sizes are allocated 
+ *     and then deallocated in the order of allocation
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "classic_common.h"
+
+// Cross-thread frees: required by the original xmalloc-test, where batches are allocated by producer threads
+// and deallocated by consumer threads. As this is not supported by iibmalloc, in this variant 
+// each thread consumes (in the same FIFO order) batches it has produced itself, so no cross-thread frees are required.
+
+struct XmallocParams
+{
+	size_t batchCount; // per thread
+	size_t batchSize;
+	size_t minObjSize;
+	size_t maxObjSize;
+};
+
+template< class AllocatorUnderTest>
+void xmallocThread( AllocatorUnderTest& allocatorUnderTest, const XmallocParams& params, size_t threadID, ClassicThreadRes& res )
+{
+	allocatorUnderTest.init( threadID );
+	uint32_t rng = classicSeed( threadID );
+	uint8_t** batch = reinterpret_cast<uint8_t**>( allocatorUnderTest.allocate( sizeof( uint8_t* ) * params.batchSize ) );
+	allocatorUnderTest.doWhateverAfterSetupPhase();
+
+	for ( size_t i=0; i<params.batchCount; ++i )
+	{
+		// produce
+		for ( size_t j=0; j<params.batchSize; ++j )
+		{
+			size_t sz = params.minObjSize + classicRandom( rng ) % ( params.maxObjSize - params.minObjSize + 1 );
+			batch[j] = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( sz ) );
+			batch[j][0] = (uint8_t)sz;
+		}
+		// consume
+		for ( size_t j=0; j<params.batchSize; ++j )
+		{
+			res.dummyCtr += batch[j][0];
+			allocatorUnderTest.deallocate( batch[j] );
+		}
+		res.opCount += params.batchSize * 2;
+		if ( ( i & 0xFF ) == 0xFF )
+			allocatorUnderTest.doWhateverWithinMainLoopPhase();
+	}
+
+	allocatorUnderTest.doWhateverAfterMainLoopPhase();
+	allocatorUnderTest.deallocate( batch );
+	allocatorUnderTest.deinit();
+	allocatorUnderTest.doWhateverAfterCleanupPhase();
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	initClassicBenchmarkLog( log );
+	printClassicBenchmarkHeader( "xmalloc-test", true, "per-thread variant: each thread deallocates its own batches; see xmalloc_test.cpp" );
+
+	XmallocParams params;
+	params.batchCount = 200;
+	params.batchSize = 4096;
+	params.minObjSize = 8;
+	params.maxObjSize = 512;
+
+	size_t threadCounts[] = { 1, 2, 4 };
+	runClassicPerThreadBenchmark( "xmalloc-test", threadCounts, sizeof( threadCounts ) / sizeof( threadCounts[0] ), [&]( auto& allocator, size_t threadID, ClassicThreadRes& res ) { xmallocThread( allocator, params, threadID, res ); } );
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
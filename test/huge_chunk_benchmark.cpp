@@ -0,0 +1,181 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * 
+ * Per-thread bucket allocator
+ * Huge chunk cache: churn of I/O-like buffers of 256 KB to 4 MB (above the bulk allocator limit, that is, mapped one by one), 
+ *     each written in full on allocation; reports throughput, minor page faults per allocation, cache hit rate and committed size 
+ *     for different cache limits and slack ratios
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "test_common.h"
+
+#include <memory>
+#include <cstring>
+
+struct HugeChunkConfig
+{
+	const char* name;
+	size_t cacheLimit; // 0 disables the cache
+	size_t slackPercent;
+	size_t slotCount; // max number of live buffers
+	bool powerOfTwoSizes; // otherwise any size in range
+};
+
+struct HugeChunkResult
+{
+	size_t dur;
+	uint64_t allocCount;
+	size_t minorFaults;
+	size_t peakCommitted;
+	HugeChunkCacheStats cacheStats;
+};
+
+constexpr size_t huge_chunk_op_count = 20000;
+constexpr size_t huge_chunk_min_size = 256 * 1024;
+constexpr size_t huge_chunk_max_size = 4 * 1024 * 1024;
+constexpr size_t huge_chunk_sample_every = 10; // operations between committed size samples
+constexpr uint64_t huge_chunk_cache_decay_ms = 1000;
+
+NODECPP_FORCEINLINE uint32_t hugeChunkRandom( uint32_t& x )
+{
+	/* Algorithm "xor" from p. 4 of Marsaglia, "Xorshift RNGs" */
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+// sizes are skewed towards the lower end (as for I/O buffers)
+NODECPP_FORCEINLINE size_t hugeChunkSize( bool powerOfTwo, uint32_t r )
+{
+	size_t exp = r % 5; // 256 KB to 4 MB
+	size_t sz = huge_chunk_min_size << ( ( exp * exp ) / 4 );
+	if ( powerOfTwo )
+		return sz;
+	return sz + ( ( r >> 8 ) % sz );
+}
+
+void runHugeChunkBenchmark( const HugeChunkConfig& config, HugeChunkResult& res )
+{
+	std::unique_ptr<IibAllocatorBase> allocator( new IibAllocatorBase );
+	allocator->setHugeChunkCacheLimits( config.cacheLimit, huge_chunk_cache_decay_ms, config.slackPercent );
+	std::unique_ptr<uint8_t*[]> slots( new uint8_t*[ config.slotCount ] );
+	memset( slots.get(), 0, sizeof( uint8_t* ) * config.slotCount );
+	uint32_t rng = 0x12345678;
+	res.peakCommitted = 0;
+
+	MemoryFootprint before;
+	sampleMemoryFootprint( before );
+	size_t start = GetMillisecondCount();
+	for ( size_t i=0; i<huge_chunk_op_count; ++i )
+	{
+		uint32_t r = hugeChunkRandom( rng );
+		uint8_t*& slot = slots[ r % config.slotCount ];
+		if ( slot )
+		{
+			allocator->deallocate( slot );
+			slot = nullptr;
+		}
+		else
+		{
+			size_t sz = hugeChunkSize( config.powerOfTwoSizes, hugeChunkRandom( rng ) );
+			slot = reinterpret_cast<uint8_t*>( allocator->allocate( sz ) );
+			memset( slot, (uint8_t)i, sz );
+			++(res.allocCount);
+		}
+
+		if ( i % huge_chunk_sample_every == 0 )
+		{
+			size_t committed = allocator->getCommittedSize();
+			if ( committed > res.peakCommitted )
+				res.peakCommitted = committed;
+		}
+	}
+	res.dur = GetMillisecondCount() - start;
+	MemoryFootprint after;
+	sampleMemoryFootprint( after );
+	res.minorFaults = after.minorFaults - before.minorFaults;
+	res.cacheStats = allocator->getHugeChunkCacheStats();
+
+	for ( size_t i=0; i<config.slotCount; ++i )
+		if ( slots[i] )
+			allocator->deallocate( slots[i] );
+}
+
+NODECPP_FORCEINLINE double hugeChunkHitRate( const HugeChunkCacheStats& stats ) { return stats.hitCount + stats.missCount ? stats.hitCount * 100. / ( stats.hitCount + stats.missCount ) : 0.; }
+
+void printHugeChunkResult( const HugeChunkConfig& config, const HugeChunkResult& res )
+{
+	double opsPerSec = res.dur ? huge_chunk_op_count * 1000. / res.dur : 0;
+	double faultsPerAlloc = res.allocCount ? res.minorFaults * 1. / res.allocCount : 0;
+	nodecpp::log::default_log::info( "{}: {} ops in {} ms, {:.0f} ops/s; {:.1f} minor faults per allocation; cache hits {:.1f}% (evicted {} MB, decayed {} MB, peak cached {} MB); peak committed {} MB", 
+		config.name, huge_chunk_op_count, res.dur, opsPerSec, faultsPerAlloc, hugeChunkHitRate( res.cacheStats ), 
+		res.cacheStats.evictedSize >> 20, res.cacheStats.decayedSize >> 20, res.cacheStats.peakCachedSize >> 20, res.peakCommitted >> 20 );
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	log.level = nodecpp::log::LogLevel::info;
+	log.add( stdout );
+	nodecpp::logging_impl::currentLog = &log;
+
+	HugeChunkConfig configs[] = {
+		{ "no cache, power-of-two sizes", 0, 0, 16, true },
+		{ "default cache (32 MB, 25% slack), power-of-two sizes", 32 << 20, 25, 16, true },
+		{ "no cache, any sizes", 0, 0, 16, false },
+		{ "default cache (32 MB, 25% slack), any sizes", 32 << 20, 25, 16, false },
+		{ "32 MB cache, no slack, any sizes", 32 << 20, 0, 16, false },
+		{ "32 MB cache, 100% slack, any sizes", 32 << 20, 100, 16, false },
+		{ "128 MB cache, 25% slack, any sizes", 128 << 20, 25, 16, false },
+		{ "8 MB cache, 25% slack, any sizes", 8 << 20, 25, 16, false },
+	};
+	constexpr size_t configCount = sizeof( configs ) / sizeof( configs[0] );
+
+	std::unique_ptr<HugeChunkResult[]> results( new HugeChunkResult[ configCount ]() );
+	for ( size_t i=0; i<configCount; ++i )
+	{
+		runHugeChunkBenchmark( configs[i], results[i] );
+		printHugeChunkResult( configs[i], results[i] );
+	}
+
+	nodecpp::log::default_log::info( "" );
+	nodecpp::log::default_log::info( "Short summary (configuration, ops/s, minor faults per allocation, hit rate %, peak committed MB):" );
+	for ( size_t i=0; i<configCount; ++i )
+	{
+		const HugeChunkResult& res = results[i];
+		double opsPerSec = res.dur ? huge_chunk_op_count * 1000. / res.dur : 0;
+		nodecpp::log::default_log::info( "{},{:.0f},{:.1f},{:.1f},{}", configs[i].name, opsPerSec, 
+			res.allocCount ? res.minorFaults * 1. / res.allocCount : 0, hugeChunkHitRate( res.cacheStats ), res.peakCommitted >> 20 );
+	}
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
@@ -0,0 +1,143 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * 
+ * Per-thread bucket allocator
+ * Reallocation of huge chunks: growable buffers (like log batches or file reads) that grow by appending up to tens of MB; 
+ *     reallocate() (remapping pages where supported) vs. allocate-copy-deallocate, with content verified at the end of each round
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "test_common.h"
+
+#include <memory>
+#include <cstring>
+
+struct HugeReallocConfig
+{
+	const char* name;
+	bool useReallocate; // otherwise allocate a new buffer, copy and deallocate the old one
+	size_t maxSize; // a buffer grows up to this size, then is deallocated
+	size_t appendSize; // bytes appended at a time
+	size_t growthPercent; // capacity growth when a buffer is full
+};
+
+struct HugeReallocResult
+{
+	size_t dur;
+	uint64_t resizeCount;
+	size_t minorFaults;
+	size_t errorCount;
+};
+
+constexpr size_t huge_realloc_round_count = 5;
+constexpr size_t huge_realloc_initial_size = 64 * 1024;
+
+void runHugeReallocBenchmark( const HugeReallocConfig& config, HugeReallocResult& res )
+{
+	std::unique_ptr<IibAllocatorBase> allocator( new IibAllocatorBase );
+
+	MemoryFootprint before;
+	sampleMemoryFootprint( before );
+	size_t start = GetMillisecondCount();
+	for ( size_t round=0; round<huge_realloc_round_count; ++round )
+	{
+		size_t capacity = huge_realloc_initial_size;
+		uint8_t* buff = reinterpret_cast<uint8_t*>( allocator->allocate( capacity ) );
+		size_t size = 0;
+		while ( size + config.appendSize <= config.maxSize )
+		{
+			if ( size + config.appendSize > capacity )
+			{
+				size_t newCapacity = capacity + capacity / 100 * config.growthPercent;
+				if ( newCapacity < size + config.appendSize )
+					newCapacity = size + config.appendSize;
+				if ( config.useReallocate )
+					buff = reinterpret_cast<uint8_t*>( allocator->reallocate( buff, newCapacity ) );
+				else
+				{
+					uint8_t* newBuff = reinterpret_cast<uint8_t*>( allocator->allocate( newCapacity ) );
+					memcpy( newBuff, buff, size );
+					allocator->deallocate( buff );
+					buff = newBuff;
+				}
+				capacity = newCapacity;
+				++(res.resizeCount);
+			}
+			memset( buff + size, (uint8_t)( size / config.appendSize + round ), config.appendSize );
+			size += config.appendSize;
+		}
+		for ( size_t off=0; off<size; off+=config.appendSize )
+			if ( buff[off] != (uint8_t)( off / config.appendSize + round ) || buff[off + config.appendSize - 1] != buff[off] )
+				++(res.errorCount);
+		allocator->deallocate( buff );
+	}
+	res.dur = GetMillisecondCount() - start;
+	MemoryFootprint after;
+	sampleMemoryFootprint( after );
+	res.minorFaults = after.minorFaults - before.minorFaults;
+}
+
+void printHugeReallocResult( const HugeReallocConfig& config, const HugeReallocResult& res )
+{
+	nodecpp::log::default_log::info( "{}: {} rounds in {} ms, {} resizes, {} minor faults, {} errors", 
+		config.name, huge_realloc_round_count, res.dur, res.resizeCount, res.minorFaults, res.errorCount );
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	log.level = nodecpp::log::LogLevel::info;
+	log.add( stdout );
+	nodecpp::logging_impl::currentLog = &log;
+
+	HugeReallocConfig configs[] = {
+		{ "64 MB by 64 KB appends, x2 growth, allocate-copy-deallocate", false, 64 << 20, 64 << 10, 100 },
+		{ "64 MB by 64 KB appends, x2 growth, reallocate()", true, 64 << 20, 64 << 10, 100 },
+		{ "64 MB by 64 KB appends, +25% growth, allocate-copy-deallocate", false, 64 << 20, 64 << 10, 25 },
+		{ "64 MB by 64 KB appends, +25% growth, reallocate()", true, 64 << 20, 64 << 10, 25 },
+		{ "4 MB by 16 KB appends, +0% growth (exact fit), allocate-copy-deallocate", false, 4 << 20, 16 << 10, 0 },
+		{ "4 MB by 16 KB appends, +0% growth (exact fit), reallocate()", true, 4 << 20, 16 << 10, 0 },
+	};
+	constexpr size_t configCount = sizeof( configs ) / sizeof( configs[0] );
+
+	std::unique_ptr<HugeReallocResult[]> results( new HugeReallocResult[ configCount ]() );
+	for ( size_t i=0; i<configCount; ++i )
+	{
+		runHugeReallocBenchmark( configs[i], results[i] );
+		printHugeReallocResult( configs[i], results[i] );
+	}
+
+	nodecpp::log::default_log::info( "" );
+	nodecpp::log::default_log::info( "Short summary (configuration, ms, resizes, minor faults, errors):" );
+	for ( size_t i=0; i<configCount; ++i )
+		nodecpp::log::default_log::info( "{},{},{},{},{}", configs[i].name, results[i].dur, results[i].resizeCount, results[i].minorFaults, results[i].errorCount );
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
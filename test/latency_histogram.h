@@ -0,0 +1,153 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Latency histogram: HDR-style log-linear histogram for per-operation timings
+ * 
+ * -------------------------------------------------------------------------------*/
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include "test_common.h"
+
+#include <string.h>
+
+
+// Values below subBucketCount are recorded exactly; each further power-of-two range is split 
+// into subBucketCount equal sub-buckets, so that relative error never exceeds 1 / subBucketCount.
+// Recording is a couple of shifts and an increment, cheap enough to be done from a measured loop.
+class LatencyHistogram
+{
+	static constexpr size_t subBucketBits = 5;
+	static constexpr size_t subBucketCount = 1 << subBucketBits;
+	static constexpr size_t slotCount = subBucketCount * ( 64 - subBucketBits + 1 );
+
+	uint64_t counts[slotCount];
+	uint64_t totalCount;
+	uint64_t minValue;
+	uint64_t maxValue;
+	uint64_t sum;
+
+	static NODECPP_FORCEINLINE size_t valueToSlot( uint64_t value )
+	{
+		if ( value < subBucketCount )
+			return (size_t)value;
+#ifdef NODECPP_MSVC
+		unsigned long msb;
+		_BitScanReverse64( &msb, value );
+#else
+		size_t msb = 63 - __builtin_clzll( value );
+#endif
+		size_t shift = msb - subBucketBits;
+		return subBucketCount + shift * subBucketCount + (size_t)( ( value >> shift ) - subBucketCount );
+	}
+
+	static uint64_t slotToHighestValue( size_t slot )
+	{
+		if ( slot < subBucketCount )
+			return slot;
+		size_t shift = ( slot - subBucketCount ) / subBucketCount;
+		uint64_t sub = ( slot - subBucketCount ) % subBucketCount;
+		return ( ( subBucketCount + sub + 1 ) << shift ) - 1;
+	}
+
+public:
+	LatencyHistogram() { reset(); }
+
+	void reset()
+	{
+		memset( counts, 0, sizeof( counts ) );
+		totalCount = 0;
+		minValue = UINT64_MAX;
+		maxValue = 0;
+		sum = 0;
+	}
+
+	NODECPP_FORCEINLINE void record( uint64_t value )
+	{
+		++(counts[ valueToSlot( value ) ]);
+		++totalCount;
+		sum += value;
+		if ( value < minValue )
+			minValue = value;
+		if ( value > maxValue )
+			maxValue = value;
+	}
+
+	void add( const LatencyHistogram& other )
+	{
+		for ( size_t i=0; i<slotCount; ++i )
+			counts[i] += other.counts[i];
+		totalCount += other.totalCount;
+		sum += other.sum;
+		if ( other.minValue < minValue )
+			minValue = other.minValue;
+		if ( other.maxValue > maxValue )
+			maxValue = other.maxValue;
+	}
+
+	uint64_t count() const { return totalCount; }
+	uint64_t min() const { return totalCount ? minValue : 0; }
+	uint64_t max() const { return maxValue; }
+	double mean() const { return totalCount ? sum * 1. / totalCount : 0; }
+
+	// highest value that is equivalent (within histogram precision) to the value at a given percentile
+	uint64_t valueAtPercentile( double percentile ) const
+	{
+		if ( totalCount == 0 )
+			return 0;
+		uint64_t countAtPercentile = (uint64_t)( percentile / 100. * totalCount + 0.5 );
+		if ( countAtPercentile == 0 )
+			countAtPercentile = 1;
+		uint64_t cumulative = 0;
+		for ( size_t i=0; i<slotCount; ++i )
+		{
+			cumulative += counts[i];
+			if ( cumulative >= countAtPercentile )
+			{
+				uint64_t ret = slotToHighestValue( i );
+				return ret < maxValue ? ret : maxValue;
+			}
+		}
+		return maxValue;
+	}
+};
+
+// prints a single line with percentiles; values are converted from RDTSC ticks to nanoseconds
+inline void printLatencyPercentiles( const char* prefix, const LatencyHistogram& h )
+{
+	nodecpp::log::default_log::info( "{}count = {}, mean = {:.1f} ns, p50 = {} ns, p90 = {} ns, p99 = {} ns, p99.9 = {} ns, p99.99 = {} ns, max = {} ns", 
+		prefix, h.count(), rdtscToNanoseconds( 1 ) * h.mean(),
+		(uint64_t)(rdtscToNanoseconds( h.valueAtPercentile( 50 ) )),
+		(uint64_t)(rdtscToNanoseconds( h.valueAtPercentile( 90 ) )),
+		(uint64_t)(rdtscToNanoseconds( h.valueAtPercentile( 99 ) )),
+		(uint64_t)(rdtscToNanoseconds( h.valueAtPercentile( 99.9 ) )),
+		(uint64_t)(rdtscToNanoseconds( h.valueAtPercentile( 99.99 ) )),
+		(uint64_t)(rdtscToNanoseconds( h.max() )) );
+}
+
+#endif // LATENCY_HISTOGRAM_H
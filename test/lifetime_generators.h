@@ -0,0 +1,192 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Generators of allocation streams with realistic object lifetimes: 
+ *     objects are allocated in the course of (reactor) events, and each object lives for a given number of events
+ * 
+ * -------------------------------------------------------------------------------*/
+#ifndef LIFETIME_GENERATORS_H
+#define LIFETIME_GENERATORS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// In real reactors most objects die within the event that has created them, some live for a session, 
+// and a few live (almost) forever; it is this lifetime structure that drives fragmentation.
+enum class LIFETIME_GENERATOR { none, generational, request_response, string_heavy, slow_leak };
+
+struct GeneratedAllocation
+{
+	static constexpr uint32_t immortal = UINT32_MAX; // lives until thread exit
+	size_t sz;
+	uint32_t lifetime; // in events; 0 means that an object dies at the end of the event in which it is created
+};
+
+class LifetimeGenerator
+{
+public:
+	static constexpr size_t max_allocations_per_event = 64;
+	static constexpr uint32_t max_lifetime = 0xFFFF; // not including immortal; see driver's timing wheel
+
+private:
+	LIFETIME_GENERATOR type;
+	size_t maxSize;
+	uint32_t sessionEvents;
+	size_t leakEvery;
+	size_t allocCount = 0;
+
+	static constexpr size_t min_size = 16;
+
+	size_t clampSize( size_t sz ) const { return sz < min_size ? min_size : ( sz > maxSize ? maxSize : sz ); }
+
+	// parsed fields, small structs, list nodes, etc
+	template<class Rng>
+	size_t smallObjectSize( Rng& rng ) { return clampSize( ( 16 + rng() % 241 ) & ~(size_t)7 ); }
+	// mostly short strings with a heavy tail
+	template<class Rng>
+	size_t stringSize( Rng& rng )
+	{
+		uint64_t r = rng();
+		size_t kind = r % 100;
+		r >>= 8;
+		if ( kind < 70 )
+			return clampSize( 16 + r % 49 );
+		else if ( kind < 95 )
+			return clampSize( 64 + r % 449 );
+		else
+			return clampSize( 512 + r % 3585 );
+	}
+	// I/O buffers, from 1KB to 64KB
+	template<class Rng>
+	size_t bufferSize( Rng& rng ) { return clampSize( (size_t)1024 << ( rng() % 7 ) ); }
+	template<class Rng>
+	uint32_t sessionLifetime( Rng& rng ) { return 1 + (uint32_t)( rng() % sessionEvents ); }
+
+	void add( GeneratedAllocation* out, size_t& cnt, size_t sz, uint32_t lifetime )
+	{
+		if ( cnt >= max_allocations_per_event )
+			return;
+		out[cnt].sz = sz;
+		out[cnt].lifetime = lifetime;
+		++cnt;
+		++allocCount;
+	}
+
+	// ~90% of objects die within an event, ~10% live for a session, and ~0.1% live for max_lifetime events
+	template<class Rng>
+	void generational( Rng& rng, GeneratedAllocation* out, size_t& cnt )
+	{
+		size_t n = 1 + rng() % 16;
+		for ( size_t i=0; i<n; ++i )
+		{
+			size_t kind = rng() % 1000;
+			if ( kind < 900 )
+				add( out, cnt, ( kind & 1 ) ? smallObjectSize( rng ) : stringSize( rng ), 0 );
+			else if ( kind < 999 )
+				add( out, cnt, ( kind & 1 ) ? smallObjectSize( rng ) : clampSize( 256 + rng() % 3841 ), sessionLifetime( rng ) );
+			else
+				add( out, cnt, bufferSize( rng ), max_lifetime );
+		}
+	}
+
+	// an event is a request: a request buffer is read and parsed into small objects, and a response is built in a growing buffer;
+	// all that dies at the end of the event; once in a while a new connection (whose state lives for a session) is accepted
+	template<class Rng>
+	void requestResponse( Rng& rng, GeneratedAllocation* out, size_t& cnt )
+	{
+		add( out, cnt, bufferSize( rng ), 0 );
+		size_t parsed = 4 + rng() % 29;
+		for ( size_t i=0; i<parsed; ++i )
+			add( out, cnt, ( i & 1 ) ? smallObjectSize( rng ) : stringSize( rng ), 0 );
+		size_t growthSteps = 1 + rng() % 10;
+		for ( size_t i=0; i<growthSteps; ++i )
+			add( out, cnt, clampSize( (size_t)64 << i ), 0 );
+		if ( rng() % 100 == 0 )
+		{
+			uint32_t lifetime = sessionLifetime( rng );
+			add( out, cnt, clampSize( 512 + rng() % 1537 ), lifetime );
+			add( out, cnt, bufferSize( rng ), lifetime );
+		}
+	}
+
+	// strings of various lengths, most of them temporaries; some are results of concatenation of previous ones
+	template<class Rng>
+	void stringHeavy( Rng& rng, GeneratedAllocation* out, size_t& cnt )
+	{
+		size_t n = 8 + rng() % 41;
+		for ( size_t i=0; i<n; ++i )
+		{
+			size_t kind = rng() % 100;
+			uint32_t lifetime = kind < 80 ? 0 : ( kind < 95 ? 1 + (uint32_t)( rng() % 16 ) : sessionLifetime( rng ) );
+			if ( cnt >= 2 && rng() % 4 == 0 )
+				add( out, cnt, clampSize( out[cnt-1].sz + out[cnt-2].sz ), lifetime );
+			else
+				add( out, cnt, stringSize( rng ), lifetime );
+		}
+	}
+
+public:
+	LifetimeGenerator( LIFETIME_GENERATOR type_, size_t maxSize_, uint32_t sessionEvents_, size_t leakEvery_ ) : 
+		type( type_ ), maxSize( maxSize_ < min_size ? min_size : maxSize_ ), 
+		sessionEvents( sessionEvents_ == 0 ? 1 : ( sessionEvents_ > max_lifetime ? max_lifetime : sessionEvents_ ) ),
+		leakEvery( leakEvery_ ) {}
+
+	size_t allocationCount() const { return allocCount; }
+
+	// fills allocations to be made during the next event; returns their number (at most max_allocations_per_event)
+	template<class Rng>
+	size_t nextEvent( Rng& rng, GeneratedAllocation* out )
+	{
+		size_t cnt = 0;
+		switch ( type )
+		{
+			case LIFETIME_GENERATOR::generational:
+				generational( rng, out, cnt );
+				break;
+			case LIFETIME_GENERATOR::request_response:
+				requestResponse( rng, out, cnt );
+				break;
+			case LIFETIME_GENERATOR::string_heavy:
+				stringHeavy( rng, out, cnt );
+				break;
+			case LIFETIME_GENERATOR::slow_leak: // generational, with each leakEvery-th allocation never freed
+			{
+				size_t before = allocCount;
+				generational( rng, out, cnt );
+				if ( leakEvery != 0 && allocCount / leakEvery != before / leakEvery )
+					out[cnt-1].lifetime = GeneratedAllocation::immortal;
+				break;
+			}
+			default:
+				break;
+		}
+		return cnt;
+	}
+};
+
+#endif // LIFETIME_GENERATORS_H
@@ -0,0 +1,397 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Application-level benchmarks: real C++ code (STL containers, strings, std::function) run with 
+ *     an allocator installed by setCurrneAllocator(), so that all allocations go through intercepted operator new/delete; 
+ *     the default allocator (new/delete over malloc) is run as a baseline
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "classic/classic_common.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <functional>
+
+// Cross-thread frees: not required; each thread runs its own copy of the application code.
+// Operation counts reported are application-level operations (documents parsed, container operations, etc), not allocations.
+
+// All containers and strings must be destroyed before allocator's deinit(), that is, before the allocator is uninstalled
+template< class AllocatorUnderTest, class Body>
+void runMacroBenchmarkThread( AllocatorUnderTest& allocatorUnderTest, size_t threadID, ClassicThreadRes& res, Body&& body )
+{
+	allocatorUnderTest.init( threadID );
+	allocatorUnderTest.doWhateverAfterSetupPhase();
+	body( allocatorUnderTest, res );
+	allocatorUnderTest.doWhateverAfterMainLoopPhase();
+	allocatorUnderTest.deinit();
+	allocatorUnderTest.doWhateverAfterCleanupPhase();
+}
+
+// a key that is long enough not to fit into std::string's small buffer
+inline std::string macroKey( uint32_t n )
+{
+	char buff[ 48 ];
+	snprintf( buff, sizeof( buff ), "session-key-%08x-%08x", n, n * 2654435761u );
+	return buff;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// JSON DOM: a document is generated as text, parsed into a DOM, walked, and destroyed
+
+struct JsonValue
+{
+	enum class Type { null, boolean, number, string, array, object };
+	Type type = Type::null;
+	double number = 0;
+	std::string str;
+	std::vector<JsonValue> array;
+	std::vector<std::pair<std::string, JsonValue>> object;
+};
+
+class JsonParser
+{
+	const char* p;
+
+	void skipWs() { while ( *p == ' ' || *p == '\n' ) ++p; }
+	std::string parseString()
+	{
+		std::string ret;
+		++p; // '"'
+		while ( *p != '"' )
+			ret.push_back( *p++ );
+		++p;
+		return ret;
+	}
+
+public:
+	JsonParser( const char* text ) : p( text ) {}
+
+	void parse( JsonValue& v )
+	{
+		skipWs();
+		if ( *p == '{' )
+		{
+			v.type = JsonValue::Type::object;
+			++p;
+			skipWs();
+			while ( *p != '}' )
+			{
+				std::string key = parseString();
+				skipWs();
+				++p; // ':'
+				v.object.emplace_back( std::move( key ), JsonValue() );
+				parse( v.object.back().second );
+				skipWs();
+				if ( *p == ',' )
+					++p;
+				skipWs();
+			}
+			++p;
+		}
+		else if ( *p == '[' )
+		{
+			v.type = JsonValue::Type::array;
+			++p;
+			skipWs();
+			while ( *p != ']' )
+			{
+				v.array.emplace_back();
+				parse( v.array.back() );
+				skipWs();
+				if ( *p == ',' )
+					++p;
+				skipWs();
+			}
+			++p;
+		}
+		else if ( *p == '"' )
+		{
+			v.type = JsonValue::Type::string;
+			v.str = parseString();
+		}
+		else if ( *p == 't' || *p == 'f' )
+		{
+			v.type = JsonValue::Type::boolean;
+			v.number = *p == 't';
+			p += *p == 't' ? 4 : 5;
+		}
+		else
+		{
+			v.type = JsonValue::Type::number;
+			char* end;
+			v.number = strtod( p, &end );
+			p = end;
+		}
+	}
+};
+
+inline void generateJson( std::string& out, uint32_t& rng, size_t depth )
+{
+	out += "{\"id\": ";
+	out += std::to_string( classicRandom( rng ) );
+	out += ", \"name\": \"";
+	out.append( 4 + classicRandom( rng ) % 40, 'a' + classicRandom( rng ) % 26 );
+	out += "\", \"active\": ";
+	out += ( classicRandom( rng ) & 1 ) ? "true" : "false";
+	out += ", \"tags\": [";
+	size_t tagCnt = classicRandom( rng ) % 8;
+	for ( size_t i=0; i<tagCnt; ++i )
+	{
+		if ( i )
+			out += ", ";
+		out += "\"";
+		out.append( 2 + classicRandom( rng ) % 20, 'a' + (char)i );
+		out += "\"";
+	}
+	out += "]";
+	if ( depth )
+	{
+		out += ", \"children\": [";
+		size_t childCnt = 1 + classicRandom( rng ) % 4;
+		for ( size_t i=0; i<childCnt; ++i )
+		{
+			if ( i )
+				out += ",\n";
+			generateJson( out, rng, depth - 1 );
+		}
+		out += "]";
+	}
+	out += "}";
+}
+
+inline double walkJson( const JsonValue& v )
+{
+	double ret = v.number + v.str.size();
+	for ( auto& item : v.array )
+		ret += walkJson( item );
+	for ( auto& member : v.object )
+		ret += member.first.size() + walkJson( member.second );
+	return ret;
+}
+
+template< class AllocatorUnderTest>
+void jsonDomThread( AllocatorUnderTest& allocatorUnderTest, size_t threadID, ClassicThreadRes& res )
+{
+	runMacroBenchmarkThread( allocatorUnderTest, threadID, res, [threadID]( auto& allocator, ClassicThreadRes& res ) {
+		uint32_t rng = classicSeed( threadID );
+		for ( size_t i=0; i<20000; ++i )
+		{
+			std::string text;
+			generateJson( text, rng, 3 );
+			JsonValue doc;
+			JsonParser( text.c_str() ).parse( doc );
+			res.dummyCtr += (uint64_t)walkJson( doc );
+			++(res.opCount);
+			if ( ( i & 0xFF ) == 0xFF )
+				allocator.doWhateverWithinMainLoopPhase();
+		}
+	} );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// std::unordered_map<std::string, ...>: sessions are looked up, created and removed at random
+
+struct MacroSession
+{
+	std::string user;
+	std::vector<uint32_t> history;
+};
+
+template< class AllocatorUnderTest>
+void unorderedMapThread( AllocatorUnderTest& allocatorUnderTest, size_t threadID, ClassicThreadRes& res )
+{
+	runMacroBenchmarkThread( allocatorUnderTest, threadID, res, [threadID]( auto& allocator, ClassicThreadRes& res ) {
+		uint32_t rng = classicSeed( threadID );
+		std::unordered_map<std::string, MacroSession> sessions;
+		for ( size_t i=0; i<2000000; ++i )
+		{
+			uint32_t r = classicRandom( rng );
+			std::string key = macroKey( r & 0x3FFF );
+			switch ( ( r >> 16 ) % 4 )
+			{
+				case 0:
+				case 1:
+				{
+					auto it = sessions.find( key );
+					if ( it != sessions.end() )
+					{
+						it->second.history.push_back( r );
+						res.dummyCtr += it->second.history.size();
+					}
+					break;
+				}
+				case 2:
+				{
+					MacroSession& s = sessions[ key ];
+					s.user = key;
+					s.history.push_back( r );
+					break;
+				}
+				default:
+					res.dummyCtr += sessions.erase( key );
+					break;
+			}
+			++(res.opCount);
+			if ( ( i & 0xFFFF ) == 0xFFFF )
+				allocator.doWhateverWithinMainLoopPhase();
+		}
+	} );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// std::map insert/erase
+
+template< class AllocatorUnderTest>
+void mapThread( AllocatorUnderTest& allocatorUnderTest, size_t threadID, ClassicThreadRes& res )
+{
+	runMacroBenchmarkThread( allocatorUnderTest, threadID, res, [threadID]( auto& allocator, ClassicThreadRes& res ) {
+		uint32_t rng = classicSeed( threadID );
+		std::map<uint64_t, std::string> m;
+		for ( size_t i=0; i<2000000; ++i )
+		{
+			uint32_t r = classicRandom( rng );
+			uint64_t key = r & 0xFFFF;
+			if ( r & 0x10000 )
+				m.emplace( key, std::string( 8 + ( r >> 20 ) % 56, 'x' ) );
+			else
+				res.dummyCtr += m.erase( key );
+			++(res.opCount);
+			if ( ( i & 0xFFFF ) == 0xFFFF )
+				allocator.doWhateverWithinMainLoopPhase();
+		}
+		res.dummyCtr += m.size();
+	} );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// std::vector growth (with default and extended alignment of elements)
+// NOTE: allocations over MaxBucketSize are only ALIGNMENT-aligned (they start right after a bulk chunk header, 
+//       and deallocate() relies on this offset), so vectors of over-aligned elements are kept small enough for buckets
+
+struct alignas(32) MacroVec4
+{
+	double v[4];
+};
+
+template< class AllocatorUnderTest>
+void vectorGrowthThread( AllocatorUnderTest& allocatorUnderTest, size_t threadID, ClassicThreadRes& res )
+{
+	runMacroBenchmarkThread( allocatorUnderTest, threadID, res, [threadID]( auto& allocator, ClassicThreadRes& res ) {
+		uint32_t rng = classicSeed( threadID );
+		for ( size_t i=0; i<100000; ++i )
+		{
+			uint32_t r = classicRandom( rng );
+			size_t len = 1 + r % 1024;
+			switch ( ( r >> 16 ) % 3 )
+			{
+				case 0:
+				{
+					std::vector<uint32_t> v;
+					for ( size_t j=0; j<len; ++j )
+						v.push_back( (uint32_t)j );
+					res.dummyCtr += v.back();
+					res.opCount += v.size();
+					break;
+				}
+				case 1:
+				{
+					std::vector<std::string> v;
+					for ( size_t j=0; j<len / 8 + 1; ++j )
+						v.push_back( macroKey( (uint32_t)j ) );
+					res.dummyCtr += v.back().size();
+					res.opCount += v.size();
+					break;
+				}
+				default:
+				{
+					std::vector<MacroVec4> v;
+					for ( size_t j=0; j<len % 64 + 1; ++j )
+						v.push_back( MacroVec4{ { (double)j, 0, 0, 0 } } );
+					res.dummyCtr += (uint64_t)v.back().v[0];
+					res.opCount += v.size();
+					break;
+				}
+			}
+			if ( ( i & 0xFFF ) == 0xFFF )
+				allocator.doWhateverWithinMainLoopPhase();
+		}
+	} );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// std::function callbacks (see also test/experimental/test_with_lambdas.cpp): 
+// lambdas capture more than fits into std::function's small buffer, so that each of them is allocated
+
+template< class AllocatorUnderTest>
+void callbacksThread( AllocatorUnderTest& allocatorUnderTest, size_t threadID, ClassicThreadRes& res )
+{
+	runMacroBenchmarkThread( allocatorUnderTest, threadID, res, [threadID]( auto& allocator, ClassicThreadRes& res ) {
+		uint32_t rng = classicSeed( threadID );
+		uint64_t ctr = 0;
+		std::vector<std::function<void(bool)>> callbacks;
+		for ( size_t i=0; i<100000; ++i )
+		{
+			size_t cnt = 1 + classicRandom( rng ) % 32;
+			for ( size_t j=0; j<cnt; ++j )
+			{
+				uint64_t a = classicRandom( rng ), b = j, c = i;
+				std::string tag = macroKey( (uint32_t)j );
+				callbacks.emplace_back( [&ctr, a, b, c, tag]( bool ok ) { ctr += ok ? a + b + c : tag.size(); } );
+			}
+			for ( auto& cb : callbacks )
+				cb( ( i & 1 ) != 0 );
+			res.opCount += cnt;
+			callbacks.clear();
+			if ( ( i & 0xFFF ) == 0xFFF )
+				allocator.doWhateverWithinMainLoopPhase();
+		}
+		res.dummyCtr += ctr;
+	} );
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	initClassicBenchmarkLog( log );
+	printClassicBenchmarkHeader( "macro benchmarks", false, "all allocations are made by STL via operator new/delete, which are intercepted by iibmalloc when it is installed as the current allocator" );
+
+	size_t threadCounts[] = { 1, 2 };
+	size_t cnt = sizeof( threadCounts ) / sizeof( threadCounts[0] );
+	runClassicPerThreadBenchmark( "json-dom", threadCounts, cnt, []( auto& allocator, size_t threadID, ClassicThreadRes& res ) { jsonDomThread( allocator, threadID, res ); } );
+	runClassicPerThreadBenchmark( "unordered_map<string>", threadCounts, cnt, []( auto& allocator, size_t threadID, ClassicThreadRes& res ) { unorderedMapThread( allocator, threadID, res ); } );
+	runClassicPerThreadBenchmark( "map", threadCounts, cnt, []( auto& allocator, size_t threadID, ClassicThreadRes& res ) { mapThread( allocator, threadID, res ); } );
+	runClassicPerThreadBenchmark( "vector-growth", threadCounts, cnt, []( auto& allocator, size_t threadID, ClassicThreadRes& res ) { vectorGrowthThread( allocator, threadID, res ); } );
+	runClassicPerThreadBenchmark( "std::function", threadCounts, cnt, []( auto& allocator, size_t threadID, ClassicThreadRes& res ) { callbacksThread( allocator, threadID, res ); } );
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
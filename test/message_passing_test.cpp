@@ -0,0 +1,345 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Message-passing benchmark: reactor threads, each owning its allocator, exchange 
+ *     messages over SPSC queues
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "allocator_under_test.h"
+#include "latency_histogram.h"
+
+#include <atomic>
+#include <thread>
+
+constexpr size_t max_reactors = 32;
+constexpr size_t queue_capacity = 1024; // must be a power of 2
+
+// Reactors form a ring: reactor i sends to reactor (i+1) % reactorCount. 
+// As iibmalloc does not support inter-thread free(), a receiver never frees a message itself: 
+// it copies the payload into memory obtained from its own allocator, processes and frees the copy, 
+// and then returns the original message to the sender, which frees it locally. 
+// This is the way (Re)Actors are supposed to exchange data when running over iibmalloc.
+
+template<size_t capacity>
+class SpscQueue
+{
+	static_assert( ( capacity & ( capacity - 1 ) ) == 0, "capacity must be a power of 2" );
+	// NOTE: padded rather than alignas(64)'ed, as over-aligned new is limited to NODECPP_MAX_SUPPORTED_ALIGNMENT_FOR_NEW
+	std::atomic<size_t> head; // updated by consumer only
+	uint8_t padding1[64 - sizeof( std::atomic<size_t> )];
+	std::atomic<size_t> tail; // updated by producer only
+	uint8_t padding2[64 - sizeof( std::atomic<size_t> )];
+	void* items[capacity];
+
+public:
+	SpscQueue() : head( 0 ), tail( 0 ) {}
+
+	bool push( void* item )
+	{
+		size_t t = tail.load( std::memory_order_relaxed );
+		if ( t - head.load( std::memory_order_acquire ) == capacity )
+			return false;
+		items[ t & ( capacity - 1 ) ] = item;
+		tail.store( t + 1, std::memory_order_release );
+		return true;
+	}
+
+	void* pop()
+	{
+		size_t h = head.load( std::memory_order_relaxed );
+		if ( h == tail.load( std::memory_order_acquire ) )
+			return nullptr;
+		void* ret = items[ h & ( capacity - 1 ) ];
+		head.store( h + 1, std::memory_order_release );
+		return ret;
+	}
+};
+
+struct Message
+{
+	uint64_t rdtscSent;
+	uint32_t payloadSize;
+	uint32_t senderID;
+	uint8_t* payload() { return reinterpret_cast<uint8_t*>( this + 1 ); }
+};
+
+struct ReactorLink
+{
+	SpscQueue<queue_capacity> forward; // sender -> receiver
+	SpscQueue<queue_capacity> backward; // consumed messages, receiver -> sender
+};
+
+struct ReactorTestRes
+{
+	ThreadTestRes allocatorRes;
+	LatencyHistogram latency; // from allocation at sender to completed processing at receiver, in RDTSC ticks
+	size_t msgSent;
+	size_t msgReceived;
+	uint64_t bytesSent;
+	uint64_t dummyCtr;
+};
+
+struct MessagePassingParams
+{
+	size_t reactorCount;
+	size_t msgCount; // sent by each reactor
+	size_t maxInFlight; // per link; as long as it does not exceed queue_capacity, queues never overflow
+	size_t burstSize; // max messages sent in a row before looking at incoming queues
+	size_t allocatorType;
+};
+
+NODECPP_FORCEINLINE uint32_t nextRandom( uint32_t& x )
+{
+	/* Algorithm "xor" from p. 4 of Marsaglia, "Xorshift RNGs" */
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+NODECPP_FORCEINLINE size_t messagePayloadSize( uint32_t& rng )
+{
+	uint32_t r = nextRandom( rng );
+	uint32_t cls = r % 100;
+	r >>= 8;
+	if ( cls < 60 ) // control messages, acks, small events
+		return 16 + r % ( 128 - 16 );
+	else if ( cls < 90 ) // typical requests and responses
+		return 128 + r % ( 1024 - 128 );
+	else if ( cls < 99 ) // larger payloads
+		return 1024 + r % ( 8 * 1024 - 1024 );
+	else // bulk transfers
+		return 8 * 1024 + r % ( 64 * 1024 - 8 * 1024 );
+}
+
+template< class AllocatorUnderTest>
+void runReactor( AllocatorUnderTest& allocatorUnderTest, const MessagePassingParams& params, size_t reactorID, ReactorLink* outLink, ReactorLink* inLink, ReactorTestRes& res, std::atomic<size_t>& readyCnt )
+{
+	constexpr size_t opsBetweenMaintenance = 10000;
+	allocatorUnderTest.init( reactorID );
+	uint32_t rng = 0x9E3779B9u ^ (uint32_t)( ( reactorID + 1 ) * 2654435761u );
+	size_t inFlight = 0;
+	size_t opCnt = 0;
+	allocatorUnderTest.doWhateverAfterSetupPhase();
+
+	++readyCnt;
+	while ( readyCnt.load( std::memory_order_acquire ) < params.reactorCount )
+		std::this_thread::yield();
+
+	while ( res.msgSent < params.msgCount || res.msgReceived < params.msgCount || inFlight )
+	{
+		bool idle = true;
+
+		// produce
+		for ( size_t i=0; i<params.burstSize && res.msgSent < params.msgCount && inFlight < params.maxInFlight; ++i )
+		{
+			size_t payloadSz = messagePayloadSize( rng );
+			Message* msg = reinterpret_cast<Message*>( allocatorUnderTest.allocate( sizeof( Message ) + payloadSz ) );
+			msg->payloadSize = (uint32_t)payloadSz;
+			msg->senderID = (uint32_t)reactorID;
+			memset( msg->payload(), (uint8_t)(res.msgSent), payloadSz );
+			msg->rdtscSent = __rdtsc();
+			bool ok = outLink->forward.push( msg );
+			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ok );
+			++inFlight;
+			++(res.msgSent);
+			res.bytesSent += payloadSz;
+			++opCnt;
+			idle = false;
+		}
+
+		// consume: copy into own memory, process, free locally, and return the original to its owner
+		while ( Message* msg = reinterpret_cast<Message*>( inLink->forward.pop() ) )
+		{
+			uint8_t* copy = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( msg->payloadSize ) );
+			memcpy( copy, msg->payload(), msg->payloadSize );
+			res.dummyCtr += copy[0] + copy[msg->payloadSize / 2] + copy[msg->payloadSize - 1];
+			allocatorUnderTest.deallocate( copy );
+			res.latency.record( __rdtsc() - msg->rdtscSent );
+			++(res.msgReceived);
+			bool ok = inLink->backward.push( msg );
+			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ok );
+			opCnt += 2;
+			idle = false;
+		}
+
+		// reclaim messages consumed by the receiver
+		while ( void* msg = outLink->backward.pop() )
+		{
+			allocatorUnderTest.deallocate( msg );
+			--inFlight;
+			++opCnt;
+			idle = false;
+		}
+
+		if ( opCnt >= opsBetweenMaintenance )
+		{
+			allocatorUnderTest.doWhateverWithinMainLoopPhase();
+			opCnt = 0;
+		}
+		if ( idle )
+			std::this_thread::yield();
+	}
+	allocatorUnderTest.doWhateverAfterMainLoopPhase();
+	allocatorUnderTest.deinit();
+	allocatorUnderTest.doWhateverAfterCleanupPhase();
+}
+
+void runReactorThread( const MessagePassingParams& params, size_t reactorID, ReactorLink* links, ReactorTestRes* res, std::atomic<size_t>& readyCnt )
+{
+	ReactorLink* outLink = links + reactorID;
+	ReactorLink* inLink = links + ( reactorID + params.reactorCount - 1 ) % params.reactorCount;
+	switch ( params.allocatorType )
+	{
+		case USE_PER_THREAD_ALLOCATOR:
+		{
+			PerThreadAllocatorUnderTest allocator( &(res[reactorID].allocatorRes) );
+			runReactor( allocator, params, reactorID, outLink, inLink, res[reactorID], readyCnt );
+			break;
+		}
+		case USE_NEW_DELETE:
+		{
+			NewDeleteUnderTest allocator( &(res[reactorID].allocatorRes) );
+			runReactor( allocator, params, reactorID, outLink, inLink, res[reactorID], readyCnt );
+			break;
+		}
+		default:
+			NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, false );
+	}
+}
+
+struct MessagePassingSummary
+{
+	size_t dur;
+	size_t msgCount;
+	uint64_t bytesSent;
+	LatencyHistogram latency;
+};
+
+void runMessagePassingTest( const MessagePassingParams& params, ReactorTestRes* res, MessagePassingSummary& summary )
+{
+	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, params.reactorCount <= max_reactors );
+	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, params.maxInFlight <= queue_capacity );
+
+	ReactorLink* links = new ReactorLink[ params.reactorCount ];
+	for ( size_t i=0; i<params.reactorCount; ++i )
+	{
+		res[i].latency.reset();
+		res[i].msgSent = 0;
+		res[i].msgReceived = 0;
+		res[i].bytesSent = 0;
+		res[i].dummyCtr = 0;
+	}
+	std::atomic<size_t> readyCnt( 0 );
+	std::thread threads[ max_reactors ];
+
+	size_t start = GetMillisecondCount();
+	for ( size_t i=0; i<params.reactorCount; ++i )
+		threads[i] = std::thread( runReactorThread, std::cref( params ), i, links, res, std::ref( readyCnt ) );
+	for ( size_t i=0; i<params.reactorCount; ++i )
+		threads[i].join();
+	size_t end = GetMillisecondCount();
+	delete [] links;
+
+	summary.dur = end - start;
+	summary.msgCount = 0;
+	summary.bytesSent = 0;
+	summary.latency.reset();
+	uint64_t dummyCtr = 0;
+	for ( size_t i=0; i<params.reactorCount; ++i )
+	{
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, res[i].msgSent == params.msgCount && res[i].msgReceived == params.msgCount );
+		summary.msgCount += res[i].msgReceived;
+		summary.bytesSent += res[i].bytesSent;
+		summary.latency.add( res[i].latency );
+		dummyCtr += res[i].dummyCtr;
+	}
+
+	nodecpp::log::default_log::info( "{} reactors passed {} messages ({} MB) in {} ms: {:.0f} messages/s [ctr = {}]", params.reactorCount, summary.msgCount, summary.bytesSent >> 20, summary.dur, summary.dur ? summary.msgCount * 1000. / summary.dur : 0., dummyCtr );
+	printLatencyPercentiles( "    latency: ", summary.latency );
+	for ( size_t i=0; i<params.reactorCount; ++i )
+	{
+		nodecpp::log::default_log::info( "    reactor {}: {}ms", i, res[i].allocatorRes.innerDur );
+		printLatencyPercentiles( "        latency: ", res[i].latency );
+	}
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	log.level = nodecpp::log::LogLevel::info;
+	log.add( stdout );
+	nodecpp::logging_impl::currentLog = &log;
+
+	rdtscToNanoseconds( 1 ); // calibrate before any reactor is started
+
+	MessagePassingParams params;
+	params.msgCount = 200000;
+	params.maxInFlight = 256;
+	params.burstSize = 16;
+
+	size_t reactorCountMax = 4;
+	ReactorTestRes* res = new ReactorTestRes[ max_reactors ];
+	MessagePassingSummary* newDelSummary = new MessagePassingSummary[ reactorCountMax + 1 ];
+	MessagePassingSummary* perThreadSummary = new MessagePassingSummary[ reactorCountMax + 1 ];
+
+	for ( params.reactorCount=2; params.reactorCount<=reactorCountMax; params.reactorCount *= 2 )
+	{
+		for ( size_t i=0; i<max_reactors; ++i )
+			memset( &(res[i].allocatorRes), 0, sizeof( ThreadTestRes ) );
+
+		nodecpp::log::default_log::info( "Running message passing test with {} reactors using new/delete...", params.reactorCount );
+		params.allocatorType = USE_NEW_DELETE;
+		runMessagePassingTest( params, res, newDelSummary[params.reactorCount] );
+
+		nodecpp::log::default_log::info( "Running message passing test with {} reactors using per-thread allocator...", params.reactorCount );
+		params.allocatorType = USE_PER_THREAD_ALLOCATOR;
+		runMessagePassingTest( params, res, perThreadSummary[params.reactorCount] );
+	}
+
+	nodecpp::log::default_log::info( "" );
+	nodecpp::log::default_log::info( "Message passing summary (reactors, msg/s new/delete, msg/s per-thread, p50/p99/p99.9 ns new/delete, p50/p99/p99.9 ns per-thread):" );
+	for ( size_t reactorCount=2; reactorCount<=reactorCountMax; reactorCount *= 2 )
+	{
+		MessagePassingSummary& nd = newDelSummary[reactorCount];
+		MessagePassingSummary& pt = perThreadSummary[reactorCount];
+		nodecpp::log::default_log::info( "{},{:.0f},{:.0f},{}/{}/{},{}/{}/{}", reactorCount, 
+			nd.dur ? nd.msgCount * 1000. / nd.dur : 0., pt.dur ? pt.msgCount * 1000. / pt.dur : 0.,
+			(uint64_t)rdtscToNanoseconds( nd.latency.valueAtPercentile( 50 ) ), (uint64_t)rdtscToNanoseconds( nd.latency.valueAtPercentile( 99 ) ), (uint64_t)rdtscToNanoseconds( nd.latency.valueAtPercentile( 99.9 ) ),
+			(uint64_t)rdtscToNanoseconds( pt.latency.valueAtPercentile( 50 ) ), (uint64_t)rdtscToNanoseconds( pt.latency.valueAtPercentile( 99 ) ), (uint64_t)rdtscToNanoseconds( pt.latency.valueAtPercentile( 99.9 ) ) );
+	}
+
+	delete [] perThreadSummary;
+	delete [] newDelSummary;
+	delete [] res;
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
@@ -42,9 +42,11 @@ void* runRandomTest( void* params )
 {
 	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, params != nullptr );
 	ThreadStartupParamsAndResults* testParams = reinterpret_cast<ThreadStartupParamsAndResults*>( params );
+	rnd_seed = testParams->startupParams.seed + testParams->threadID * testParams->startupParams.seedThreadStride;
 	switch ( testParams->startupParams.calcMod )
 	{
 		case USE_RANDOMPOS_RANDOMSIZE:
+		case USE_GENERATED_LIFETIMES:
 		{
 			switch ( testParams->startupParams.allocatorType )
 			{
@@ -55,13 +57,13 @@ void* runRandomTest( void* params )
 					switch ( testParams->startupParams.mat )
 					{
 						case MEM_ACCESS_TYPE::none:
-							randomPos_RandomSize<PerThreadAllocatorUnderTest,MEM_ACCESS_TYPE::none>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<PerThreadAllocatorUnderTest,MEM_ACCESS_TYPE::none>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 						case MEM_ACCESS_TYPE::full:
-							randomPos_RandomSize<PerThreadAllocatorUnderTest,MEM_ACCESS_TYPE::full>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<PerThreadAllocatorUnderTest,MEM_ACCESS_TYPE::full>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 						case MEM_ACCESS_TYPE::single:
-							randomPos_RandomSize<PerThreadAllocatorUnderTest,MEM_ACCESS_TYPE::single>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<PerThreadAllocatorUnderTest,MEM_ACCESS_TYPE::single>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 					}
 					break;
@@ -73,13 +75,31 @@ void* runRandomTest( void* params )
 					switch ( testParams->startupParams.mat )
 					{
 						case MEM_ACCESS_TYPE::none:
-							randomPos_RandomSize<NewDeleteUnderTest,MEM_ACCESS_TYPE::none>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<NewDeleteUnderTest,MEM_ACCESS_TYPE::none>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 						case MEM_ACCESS_TYPE::full:
-							randomPos_RandomSize<NewDeleteUnderTest,MEM_ACCESS_TYPE::full>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<NewDeleteUnderTest,MEM_ACCESS_TYPE::full>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 						case MEM_ACCESS_TYPE::single:
-							randomPos_RandomSize<NewDeleteUnderTest,MEM_ACCESS_TYPE::single>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<NewDeleteUnderTest,MEM_ACCESS_TYPE::single>( allocator, testParams->startupParams, testParams->threadID );
+							break;
+					}
+					break;
+				}
+				case USE_EXTERNAL_MALLOC:
+				{
+					ExternalMallocUnderTest allocator( testParams->threadResExternal );
+					nodecpp::log::default_log::info( "    running thread {} with randomPos_RandomSize_FullMemAccess UsingExternalMalloc({}) [rnd_seed = {}] ...", testParams->threadID, ExternalMallocLibrary::path(), rnd_seed );
+					switch ( testParams->startupParams.mat )
+					{
+						case MEM_ACCESS_TYPE::none:
+							runTestScenario<ExternalMallocUnderTest,MEM_ACCESS_TYPE::none>( allocator, testParams->startupParams, testParams->threadID );
+							break;
+						case MEM_ACCESS_TYPE::full:
+							runTestScenario<ExternalMallocUnderTest,MEM_ACCESS_TYPE::full>( allocator, testParams->startupParams, testParams->threadID );
+							break;
+						case MEM_ACCESS_TYPE::single:
+							runTestScenario<ExternalMallocUnderTest,MEM_ACCESS_TYPE::single>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 					}
 					break;
@@ -91,13 +111,13 @@ void* runRandomTest( void* params )
 					switch ( testParams->startupParams.mat )
 					{
 						case MEM_ACCESS_TYPE::none:
-							randomPos_RandomSize<FakeAllocatorUnderTest,MEM_ACCESS_TYPE::none>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<FakeAllocatorUnderTest,MEM_ACCESS_TYPE::none>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 						case MEM_ACCESS_TYPE::full:
-							randomPos_RandomSize<FakeAllocatorUnderTest,MEM_ACCESS_TYPE::full>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<FakeAllocatorUnderTest,MEM_ACCESS_TYPE::full>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 						case MEM_ACCESS_TYPE::single:
-							randomPos_RandomSize<FakeAllocatorUnderTest,MEM_ACCESS_TYPE::single>( allocator, testParams->startupParams.iterCount, testParams->startupParams.maxItems, testParams->startupParams.maxItemSize, testParams->threadID );
+							runTestScenario<FakeAllocatorUnderTest,MEM_ACCESS_TYPE::single>( allocator, testParams->startupParams, testParams->threadID );
 							break;
 					}
 					break;
@@ -128,6 +148,7 @@ void doTest( TestStartupParamsAndResults* startupParams )
 		testParams[i].threadResEmpty = startupParams->testRes->threadResEmpty + i;
 		testParams[i].threadResNewDel = startupParams->testRes->threadResNewDel + i;
 		testParams[i].threadResPerThreadAlloc = startupParams->testRes->threadResPerThreadAlloc + i;
+		testParams[i].threadResExternal = startupParams->testRes->threadResExternal + i;
 	}
 
 	// run thread
@@ -148,12 +169,65 @@ void doTest( TestStartupParamsAndResults* startupParams )
 	}
 }
 
+void setUpLatencySampling( ThreadTestRes* res, size_t threadCount, size_t sampleEvery )
+{
+	for ( size_t i=0; i<threadCount; ++i )
+		res[i].latency = sampleEvery ? new OpLatencyStats( sampleEvery ) : nullptr;
+}
+
+// prints distributions merged over all threads, and releases per-thread ones
+void reportLatencySampling( const char* prefix, ThreadTestRes* res, size_t threadCount )
+{
+	if ( threadCount == 0 || res[0].latency == nullptr )
+		return;
+	OpLatencyStats* total = new OpLatencyStats( res[0].latency->sampleEvery );
+	for ( size_t i=0; i<threadCount; ++i )
+	{
+		total->add( *(res[i].latency) );
+		delete res[i].latency;
+		res[i].latency = nullptr;
+	}
+	printOpLatencyStats( prefix, *total );
+	delete total;
+}
+
+// allocators that have run, as rows; times are net of the empty test (if it has run)
+void printSideBySideTable( const TestStartupParamsAndResults& params, size_t allocatorType )
+{
+	struct Row { size_t type; const char* name; size_t dur; const MemoryFootprintSummary* mem; };
+	const TestRes& tr = *(params.testRes);
+	Row rows[] = {
+		{ USE_PER_THREAD_ALLOCATOR, "iibmalloc (per-thread)", tr.durPerThreadAlloc, &tr.memPerThreadAlloc },
+		{ USE_NEW_DELETE, "new/delete", tr.durNewDel, &tr.memNewDel },
+		{ USE_EXTERNAL_MALLOC, ExternalMallocLibrary::isLoaded() ? ExternalMallocLibrary::path() : "", tr.durExternal, &tr.memExternal },
+	};
+	size_t cnt = 0;
+	for ( const Row& row : rows )
+		if ( ( allocatorType & row.type ) && ( row.type != USE_EXTERNAL_MALLOC || ExternalMallocLibrary::isLoaded() ) )
+			++cnt;
+	if ( cnt < 2 )
+		return;
+	size_t emptyDur = ( allocatorType & USE_EMPTY_TEST ) ? tr.durEmpty : 0;
+	size_t baseDur = ( allocatorType & USE_PER_THREAD_ALLOCATOR ) && tr.durPerThreadAlloc > emptyDur ? tr.durPerThreadAlloc - emptyDur : 0;
+	size_t opCnt = params.startupParams.iterCount * params.startupParams.threadCount;
+
+	nodecpp::log::default_log::info( "Side-by-side: {} threads, {} operations (allocator, ms, ms per 1 million, time relative to iibmalloc, peak RSS KB, RSS per live byte, retained RSS KB):", params.startupParams.threadCount, opCnt );
+	for ( const Row& row : rows )
+	{
+		if ( !( allocatorType & row.type ) || ( row.type == USE_EXTERNAL_MALLOC && !ExternalMallocLibrary::isLoaded() ) )
+			continue;
+		size_t netDur = row.dur > emptyDur ? row.dur - emptyDur : 0;
+		nodecpp::log::default_log::info( "    {},{},{},{:.2f},{},{:.3f},{}", row.name, row.dur, netDur * 1000000 / opCnt, baseDur ? netDur * 1. / baseDur : 0., row.mem->peakRss >> 10, row.mem->rssPerLiveByte(), row.mem->retainedRss() >> 10 );
+	}
+}
+
 void runComparisonTest( TestStartupParamsAndResults& params )
 {
 	size_t memPageSize = nodecpp::VirtualMemory::getPageSize();
 	nodecpp::log::default_log::info( "Memory page size: {} (0x{:x}) bytes", memPageSize, memPageSize );
 	
 	size_t start, end;
+	MemoryFootprint mfBefore, mfAfter;
 	size_t threadCount = params.startupParams.threadCount;
 
 	size_t allocatorType = params.startupParams.allocatorType;
@@ -162,9 +236,16 @@ void runComparisonTest( TestStartupParamsAndResults& params )
 	{
 		params.startupParams.allocatorType = USE_EMPTY_TEST;
 
+		setUpLatencySampling( params.testRes->threadResEmpty, threadCount, params.startupParams.latencySampleEvery );
+		resetPeakRss();
+		sampleMemoryFootprint( mfBefore );
 		start = GetMillisecondCount();
 		doTest( &params );
 		end = GetMillisecondCount();
+		sampleMemoryFootprint( mfAfter );
+		summarizeMemoryFootprint( params.testRes->memEmpty, mfBefore, mfAfter, params.testRes->threadResEmpty, threadCount );
+		printMemoryFootprintSummary( "empty test: ", params.testRes->memEmpty );
+		reportLatencySampling( "empty test: ", params.testRes->threadResEmpty, threadCount );
 		params.testRes->durEmpty = end - start;
 		nodecpp::log::default_log::info( "{} threads made {} alloc/dealloc operations in {} ms ({} ms per 1 million)", threadCount, params.startupParams.iterCount * threadCount, end - start, (end - start) * 1000000 / (params.startupParams.iterCount * threadCount) );
 		params.testRes->cumulativeDurEmpty = 0;
@@ -177,9 +258,16 @@ void runComparisonTest( TestStartupParamsAndResults& params )
 	{
 		params.startupParams.allocatorType = USE_NEW_DELETE;
 
+		setUpLatencySampling( params.testRes->threadResNewDel, threadCount, params.startupParams.latencySampleEvery );
+		resetPeakRss();
+		sampleMemoryFootprint( mfBefore );
 		start = GetMillisecondCount();
 		doTest( &params );
 		end = GetMillisecondCount();
+		sampleMemoryFootprint( mfAfter );
+		summarizeMemoryFootprint( params.testRes->memNewDel, mfBefore, mfAfter, params.testRes->threadResNewDel, threadCount );
+		printMemoryFootprintSummary( "new/delete: ", params.testRes->memNewDel );
+		reportLatencySampling( "new/delete: ", params.testRes->threadResNewDel, threadCount );
 		params.testRes->durNewDel = end - start;
 		nodecpp::log::default_log::info( "{} threads made {} alloc/dealloc operations in {} ms ({} ms per 1 million)", threadCount, params.startupParams.iterCount * threadCount, end - start, (end - start) * 1000000 / (params.startupParams.iterCount * threadCount) );
 		params.testRes->cumulativeDurNewDel = 0;
@@ -192,9 +280,16 @@ void runComparisonTest( TestStartupParamsAndResults& params )
 	{
 		params.startupParams.allocatorType = USE_PER_THREAD_ALLOCATOR;
 
+		setUpLatencySampling( params.testRes->threadResPerThreadAlloc, threadCount, params.startupParams.latencySampleEvery );
+		resetPeakRss();
+		sampleMemoryFootprint( mfBefore );
 		start = GetMillisecondCount();
 		doTest( &params );
 		end = GetMillisecondCount();
+		sampleMemoryFootprint( mfAfter );
+		summarizeMemoryFootprint( params.testRes->memPerThreadAlloc, mfBefore, mfAfter, params.testRes->threadResPerThreadAlloc, threadCount );
+		printMemoryFootprintSummary( "per-thread allocator: ", params.testRes->memPerThreadAlloc );
+		reportLatencySampling( "per-thread allocator: ", params.testRes->threadResPerThreadAlloc, threadCount );
 		params.testRes->durPerThreadAlloc = end - start;
 		nodecpp::log::default_log::info( "{} threads made {} alloc/dealloc operations in {} ms ({} ms per 1 million)", threadCount, params.startupParams.iterCount * threadCount, end - start, (end - start) * 1000000 / (params.startupParams.iterCount * threadCount) );
 		params.testRes->cumulativeDurPerThreadAlloc = 0;
@@ -203,6 +298,30 @@ void runComparisonTest( TestStartupParamsAndResults& params )
 		params.testRes->cumulativeDurPerThreadAlloc /= threadCount;
 	}
 
+	if ( ( allocatorType & USE_EXTERNAL_MALLOC ) && ExternalMallocLibrary::isLoaded() )
+	{
+		params.startupParams.allocatorType = USE_EXTERNAL_MALLOC;
+
+		setUpLatencySampling( params.testRes->threadResExternal, threadCount, params.startupParams.latencySampleEvery );
+		resetPeakRss();
+		sampleMemoryFootprint( mfBefore );
+		start = GetMillisecondCount();
+		doTest( &params );
+		end = GetMillisecondCount();
+		sampleMemoryFootprint( mfAfter );
+		summarizeMemoryFootprint( params.testRes->memExternal, mfBefore, mfAfter, params.testRes->threadResExternal, threadCount );
+		printMemoryFootprintSummary( "external malloc: ", params.testRes->memExternal );
+		reportLatencySampling( "external malloc: ", params.testRes->threadResExternal, threadCount );
+		params.testRes->durExternal = end - start;
+		nodecpp::log::default_log::info( "{} threads made {} alloc/dealloc operations in {} ms ({} ms per 1 million)", threadCount, params.startupParams.iterCount * threadCount, end - start, (end - start) * 1000000 / (params.startupParams.iterCount * threadCount) );
+		params.testRes->cumulativeDurExternal = 0;
+		for ( size_t i=0; i<threadCount; ++i )
+			params.testRes->cumulativeDurExternal += params.testRes->threadResExternal[i].innerDur;
+		params.testRes->cumulativeDurExternal /= threadCount;
+	}
+
+	printSideBySideTable( params, allocatorType );
+
 	if ( allocatorType == TRY_ALL )
 	{
 		nodecpp::log::default_log::info( "Performance summary: {} threads, ({} - {}) / ({} - {}) = {}\n", threadCount, params.testRes->durNewDel, params.testRes->durEmpty, params.testRes->durPerThreadAlloc, params.testRes->durEmpty, (params.testRes->durNewDel - params.testRes->durEmpty) * 1. / (params.testRes->durPerThreadAlloc - params.testRes->durEmpty) );
@@ -300,46 +419,73 @@ void alignedAllocTest()
 	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, formerAlloc == &allocManager );
 }
 
-int main()
+// usage: test_iibmalloc [--workload <file>] [--external-malloc <path-to-malloc-library>]
+//     --workload: run a workload described by a file (see workload.h and test/workloads/); 
+//         if omitted, the built-in default workload (test/workloads/default.workload) is run
+//     --external-malloc (or just a path as the only argument): if a path to a malloc-compatible shared library 
+//         (jemalloc, tcmalloc, mimalloc, etc) is given, its malloc()/free() are run side-by-side with iibmalloc and new/delete
+//         (unless a workload file specifies allocators explicitly)
+int main( int argc, char* argv[] )
 {
 	nodecpp::log::Log log;
 	log.level = nodecpp::log::LogLevel::info;
 	log.add( stdout );
 	nodecpp::logging_impl::currentLog = &log;
 
+	const char* workloadPath = nullptr;
+	const char* externalMallocPath = nullptr;
+	for ( int i=1; i<argc; ++i )
+	{
+		if ( strcmp( argv[i], "--workload" ) == 0 && i + 1 < argc )
+			workloadPath = argv[++i];
+		else if ( strcmp( argv[i], "--external-malloc" ) == 0 && i + 1 < argc )
+			externalMallocPath = argv[++i];
+		else if ( argc == 2 )
+			externalMallocPath = argv[i];
+		else
+		{
+			nodecpp::log::default_log::info( "usage: {} [--workload <file>] [--external-malloc <path-to-malloc-library>]", argv[0] );
+			return 1;
+		}
+	}
+
+	WorkloadDescription workload;
+	if ( workloadPath != nullptr && !workload.load( workloadPath ) )
+		return 1;
+	if ( externalMallocPath != nullptr && !ExternalMallocLibrary::load( externalMallocPath ) )
+		return 1;
+	if ( ExternalMallocLibrary::isLoaded() && workloadPath == nullptr )
+		workload.allocatorType = USE_PER_THREAD_ALLOCATOR | USE_NEW_DELETE | USE_EXTERNAL_MALLOC;
+	workload.print();
+
+	rdtscToNanoseconds( 1 ); // calibrate before any test thread is started
+
 	alignedAllocTest();
 
-	TestRes testRes[max_threads];
+	TestRes* testRes = new TestRes[max_threads];
 
 	if( 1 )
 	{
-		memset( testRes, 0, sizeof( testRes ) );
+		memset( testRes, 0, sizeof( TestRes ) * max_threads );
 
 		TestStartupParamsAndResults params;
-		params.startupParams.iterCount = 100000;
-		params.startupParams.maxItemSize = 16;
+		params.startupParams.applyWorkload( workload ); // iterCount, maxItemSize, allocatorType, mat, latencySampleEvery (e.g. 16 to get latency percentiles of operations), etc
 //		params.startupParams.maxItems = 23 << 20;
 		params.startupParams.maxItemSize2 = 16;
 		params.startupParams.maxItems2 = 16;
 		params.startupParams.memReadCnt = 0;
-//		params.startupParams.allocatorType = TRY_ALL;
-//		params.startupParams.allocatorType = USE_EMPTY_TEST;
-//		params.startupParams.allocatorType = USE_NEW_DELETE;
-		params.startupParams.allocatorType = USE_PER_THREAD_ALLOCATOR;
-		params.startupParams.calcMod = USE_RANDOMPOS_RANDOMSIZE;
-		params.startupParams.mat = MEM_ACCESS_TYPE::full;
 
-		size_t threadCountMax = 1;
+		size_t threadCountMax = workload.threadCountMax;
 
-		for ( params.startupParams.threadCount=1; params.startupParams.threadCount<=threadCountMax; ++(params.startupParams.threadCount) )
+		for ( params.startupParams.threadCount=workload.threadCountMin; params.startupParams.threadCount<=threadCountMax; ++(params.startupParams.threadCount) )
 		{
-			params.startupParams.maxItems = (1 << 25) / params.startupParams.threadCount;
+			params.startupParams.maxItems = workload.totalItems / params.startupParams.threadCount;
 			params.testRes = testRes + params.startupParams.threadCount;
 			runComparisonTest( params );
 		}
 
 		nodecpp::log::default_log::info( "Test summary for USE_RANDOMPOS_RANDOMSIZE:" );
-		for ( size_t threadCount=1; threadCount<=threadCountMax; ++threadCount )
+		for ( size_t threadCount=workload.threadCountMin; threadCount<=threadCountMax; ++threadCount )
 		{
 			TestRes& tr = testRes[threadCount];
 			if ( params.startupParams.allocatorType == TRY_ALL )
@@ -356,25 +502,39 @@ int main()
 					printThreadStats( "\t", tr.threadResNewDel[i] );
 				if ( params.startupParams.allocatorType & USE_PER_THREAD_ALLOCATOR )
 					printThreadStatsEx( "\t", tr.threadResPerThreadAlloc[i] );
+				if ( ( params.startupParams.allocatorType & USE_EXTERNAL_MALLOC ) && ExternalMallocLibrary::isLoaded() )
+					printThreadStats( "\t", tr.threadResExternal[i] );
 			}
 		}
 		nodecpp::log::default_log::info( "" );
 
 		nodecpp::log::default_log::info( "Short test summary for USE_RANDOMPOS_RANDOMSIZE:" );
-		for ( size_t threadCount=1; threadCount<=threadCountMax; ++threadCount )
+		for ( size_t threadCount=workload.threadCountMin; threadCount<=threadCountMax; ++threadCount )
 			if ( params.startupParams.allocatorType == TRY_ALL )
 				nodecpp::log::default_log::info( "{},{},{},{},{}", threadCount, testRes[threadCount].durEmpty, testRes[threadCount].durNewDel, testRes[threadCount].durPerThreadAlloc, (testRes[threadCount].durNewDel - testRes[threadCount].durEmpty) * 1. / (testRes[threadCount].durPerThreadAlloc - testRes[threadCount].durEmpty) );
 			else
 				nodecpp::log::default_log::info( "{},{},{},{}", threadCount, testRes[threadCount].durEmpty, testRes[threadCount].durNewDel, testRes[threadCount].durPerThreadAlloc );
 
+		nodecpp::log::default_log::info( "Memory footprint summary for USE_RANDOMPOS_RANDOMSIZE (threads, peak RSS KB, RSS per live byte, retained RSS KB; empty | new/delete | per-thread):" );
+		for ( size_t threadCount=workload.threadCountMin; threadCount<=threadCountMax; ++threadCount )
+		{
+			TestRes& tr = testRes[threadCount];
+			nodecpp::log::default_log::info( "{},{},{:.3f},{},{},{:.3f},{},{},{:.3f},{}", threadCount, 
+				tr.memEmpty.peakRss >> 10, tr.memEmpty.rssPerLiveByte(), tr.memEmpty.retainedRss() >> 10,
+				tr.memNewDel.peakRss >> 10, tr.memNewDel.rssPerLiveByte(), tr.memNewDel.retainedRss() >> 10,
+				tr.memPerThreadAlloc.peakRss >> 10, tr.memPerThreadAlloc.rssPerLiveByte(), tr.memPerThreadAlloc.retainedRss() >> 10 );
+		}
+
 		nodecpp::log::default_log::info( "Short test summary for USE_RANDOMPOS_RANDOMSIZE (alt computations):" );
-		for ( size_t threadCount=1; threadCount<=threadCountMax; ++threadCount )
+		for ( size_t threadCount=workload.threadCountMin; threadCount<=threadCountMax; ++threadCount )
 			if ( params.startupParams.allocatorType == TRY_ALL )
 				nodecpp::log::default_log::info( "{},{},{},{},{}", threadCount, testRes[threadCount].cumulativeDurEmpty, testRes[threadCount].cumulativeDurNewDel, testRes[threadCount].cumulativeDurPerThreadAlloc, (testRes[threadCount].cumulativeDurNewDel - testRes[threadCount].cumulativeDurEmpty) * 1. / (testRes[threadCount].cumulativeDurPerThreadAlloc - testRes[threadCount].cumulativeDurEmpty) );
 			else
 				nodecpp::log::default_log::info( "{},{},{},{}", threadCount, testRes[threadCount].cumulativeDurEmpty, testRes[threadCount].cumulativeDurNewDel, testRes[threadCount].cumulativeDurPerThreadAlloc );
 	}
 
+	delete [] testRes;
+
 	nodecpp::log::default_log::info( "about to exit...                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                         " );
 	return 0;
 }
@@ -34,6 +34,9 @@
 #define ALLOCATOR_RANDOM_TEST_H
 
 #include "test_common.h"
+#include "allocator_under_test.h"
+#include "latency_histogram.h"
+#include "workload.h"
 
 #include <stdint.h>
 #define NOMINMAX
@@ -46,6 +49,7 @@
 #include <chrono>
 #include <random>
 #include <limits.h>
+#include <math.h>
 
 #ifdef NODECPP_MSVC
 #include <intrin.h>
@@ -135,47 +139,9 @@ inline void testDistribution()
 	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, total == testCnt );
 }
 
-enum { TRY_ALL = 0xFFFFFFFF, USE_EMPTY_TEST = 0x1, USE_PER_THREAD_ALLOCATOR = 0x2, USE_NEW_DELETE = 0x4, };
-enum { USE_RANDOMPOS_RANDOMSIZE };
-enum MEM_ACCESS_TYPE { none, single, full };
+enum { USE_RANDOMPOS_RANDOMSIZE, USE_GENERATED_LIFETIMES };
 
 
-struct CommonTestResults
-{
-	size_t threadID;
-
-	size_t innerDur;
-
-	uint64_t rdtscBegin;
-	uint64_t rdtscSetup;
-	uint64_t rdtscMainLoop;
-	uint64_t rdtscExit;
-};
-
-struct ThreadTestRes : public CommonTestResults
-{
-	size_t sysAllocCallCntAfterSetup;
-	size_t sysDeallocCallCntAfterSetup;
-	size_t sysAllocCallCntAfterMainLoop;
-	size_t sysDeallocCallCntAfterMainLoop;
-	size_t sysAllocCallCntAfterExit;
-	size_t sysDeallocCallCntAfterExit;
-
-	uint64_t rdtscSysAllocCallSumAfterSetup;
-	uint64_t rdtscSysDeallocCallSumAfterSetup;
-	uint64_t rdtscSysAllocCallSumAfterMainLoop;
-	uint64_t rdtscSysDeallocCallSumAfterMainLoop;
-	uint64_t rdtscSysAllocCallSumAfterExit;
-	uint64_t rdtscSysDeallocCallSumAfterExit;
-
-	uint64_t allocRequestCountAfterSetup;
-	uint64_t deallocRequestCountAfterSetup;
-	uint64_t allocRequestCountAfterMainLoop;
-	uint64_t deallocRequestCountAfterMainLoop;
-	uint64_t allocRequestCountAfterExit;
-	uint64_t deallocRequestCountAfterExit;
-};
-
 void printThreadStats( const char* prefix, ThreadTestRes& res )
 {
 	uint64_t rdtscTotal = res.rdtscExit - res.rdtscBegin;
@@ -208,6 +174,108 @@ void printThreadStatsEx( const char* prefix, ThreadTestRes& res )
 		res.deallocRequestCountAfterSetup, res.sysDeallocCallCntAfterSetup, res.rdtscSysDeallocCallSumAfterSetup, res.sysDeallocCallCntAfterSetup ? res.rdtscSysDeallocCallSumAfterSetup / res.sysDeallocCallCntAfterSetup : 0,
 		res.deallocRequestCountAfterMainLoop - res.deallocRequestCountAfterSetup, mainLoopDeallocCnt, mainLoopDeallocCntRdtsc, mainLoopDeallocCnt ? mainLoopDeallocCntRdtsc / mainLoopDeallocCnt : 0,
 		res.deallocRequestCountAfterExit - res.deallocRequestCountAfterMainLoop, exitDeallocCnt, exitDeallocCntRdtsc, exitDeallocCnt ? exitDeallocCntRdtsc / exitDeallocCnt : 0 );
+	nodecpp::log::default_log::info( "{}\tcommitted: {} KB | {} KB | {} KB; live: {} KB | {} KB", 
+		prefix, res.committedSizeAfterSetup >> 10, res.committedSizeAfterMainLoop >> 10, res.committedSizeAfterExit >> 10, res.liveBytesAfterSetup >> 10, res.liveBytesAfterMainLoop >> 10 );
+}
+
+// Latency of every sampleEvery-th operation of the main loop, in RDTSC ticks. 
+// Operations are split into fast and slow path by checking whether the allocator under test has reported 
+// entering its slow path (see IibAllocatorBase::getSlowPathCount(); allocators not reporting it have all operations in the fast path).
+// Calls to doWhateverWithinMainLoopPhase() (that is, periodic killAllZombies() for the per-thread allocator) are all measured.
+struct OpLatencyStats
+{
+	size_t sampleEvery;
+	LatencyHistogram allocFast;
+	LatencyHistogram allocSlow;
+	LatencyHistogram deallocFast;
+	LatencyHistogram deallocSlow;
+	LatencyHistogram mainLoopMaintenance;
+
+	OpLatencyStats( size_t sampleEvery_ ) : sampleEvery( sampleEvery_ ) {}
+
+	void add( const OpLatencyStats& other )
+	{
+		allocFast.add( other.allocFast );
+		allocSlow.add( other.allocSlow );
+		deallocFast.add( other.deallocFast );
+		deallocSlow.add( other.deallocSlow );
+		mainLoopMaintenance.add( other.mainLoopMaintenance );
+	}
+};
+
+template< class AllocatorUnderTest>
+NODECPP_FORCEINLINE void* sampledAllocate( AllocatorUnderTest& allocatorUnderTest, size_t sz, OpLatencyStats& latency )
+{
+	size_t slowPathCount = allocatorUnderTest.slowPathCount();
+	uint64_t start = __rdtsc();
+	void* ret = allocatorUnderTest.allocate( sz );
+	uint64_t end = __rdtsc();
+	if ( allocatorUnderTest.slowPathCount() == slowPathCount )
+		latency.allocFast.record( end - start );
+	else
+		latency.allocSlow.record( end - start );
+	return ret;
+}
+
+template< class AllocatorUnderTest>
+NODECPP_FORCEINLINE void sampledDeallocate( AllocatorUnderTest& allocatorUnderTest, void* ptr, OpLatencyStats& latency )
+{
+	size_t slowPathCount = allocatorUnderTest.slowPathCount();
+	uint64_t start = __rdtsc();
+	allocatorUnderTest.deallocate( ptr );
+	uint64_t end = __rdtsc();
+	if ( allocatorUnderTest.slowPathCount() == slowPathCount )
+		latency.deallocFast.record( end - start );
+	else
+		latency.deallocSlow.record( end - start );
+}
+
+inline void printOpLatencyStats( const char* prefix, const OpLatencyStats& latency )
+{
+	nodecpp::log::default_log::info( "{}latency (every {}-th operation of the main loop):", prefix, latency.sampleEvery );
+	printLatencyPercentiles( "        allocate, fast path: ", latency.allocFast );
+	printLatencyPercentiles( "        allocate, slow path: ", latency.allocSlow );
+	printLatencyPercentiles( "        deallocate, fast path: ", latency.deallocFast );
+	printLatencyPercentiles( "        deallocate, slow path: ", latency.deallocSlow );
+	printLatencyPercentiles( "        doWhateverWithinMainLoopPhase() (killAllZombies()): ", latency.mainLoopMaintenance );
+}
+
+// process-wide memory footprint of a single run of a test (that is, with a given allocator and thread count)
+struct MemoryFootprintSummary
+{
+	size_t rssBegin; // before threads are started
+	size_t peakRss; // where resetting peak RSS is not supported, since process start
+	size_t rssAfterMainLoop; // max over threads
+	size_t rssAfterExit; // max over threads; sampled after cleanup, while allocators are still alive
+	uint64_t liveBytesAfterMainLoop; // sum over threads
+	uint64_t committedSizeAfterMainLoop; // sum over threads; as reported by the allocator, if available
+	uint64_t committedSizeAfterExit;
+
+	double rssPerLiveByte() const { return liveBytesAfterMainLoop ? ( rssAfterMainLoop > rssBegin ? rssAfterMainLoop - rssBegin : 0 ) * 1. / liveBytesAfterMainLoop : 0.; }
+	size_t retainedRss() const { return rssAfterExit > rssBegin ? rssAfterExit - rssBegin : 0; }
+};
+
+inline void summarizeMemoryFootprint( MemoryFootprintSummary& summary, const MemoryFootprint& before, const MemoryFootprint& after, const ThreadTestRes* res, size_t threadCount )
+{
+	memset( &summary, 0, sizeof( MemoryFootprintSummary ) );
+	summary.rssBegin = before.rss;
+	summary.peakRss = after.peakRss;
+	for ( size_t i=0; i<threadCount; ++i )
+	{
+		summary.rssAfterMainLoop = std::max( summary.rssAfterMainLoop, res[i].memAfterMainLoop.rss );
+		summary.rssAfterExit = std::max( summary.rssAfterExit, res[i].memAfterExit.rss );
+		summary.liveBytesAfterMainLoop += res[i].liveBytesAfterMainLoop;
+		summary.committedSizeAfterMainLoop += res[i].committedSizeAfterMainLoop;
+		summary.committedSizeAfterExit += res[i].committedSizeAfterExit;
+	}
+}
+
+inline void printMemoryFootprintSummary( const char* prefix, const MemoryFootprintSummary& summary )
+{
+	nodecpp::log::default_log::info( "{}peak RSS: {} KB, RSS per live byte: {:.3f}, RSS retained after cleanup: {} KB (RSS {} -> {} -> {} KB, live {} KB, committed {} -> {} KB)", 
+		prefix, summary.peakRss >> 10, summary.rssPerLiveByte(), summary.retainedRss() >> 10, 
+		summary.rssBegin >> 10, summary.rssAfterMainLoop >> 10, summary.rssAfterExit >> 10, summary.liveBytesAfterMainLoop >> 10, 
+		summary.committedSizeAfterMainLoop >> 10, summary.committedSizeAfterExit >> 10 );
 }
 
 struct TestRes
@@ -215,12 +283,19 @@ struct TestRes
 	size_t durEmpty;
 	size_t durNewDel;
 	size_t durPerThreadAlloc;
+	size_t durExternal;
 	size_t cumulativeDurEmpty;
 	size_t cumulativeDurNewDel;
 	size_t cumulativeDurPerThreadAlloc;
+	size_t cumulativeDurExternal;
 	ThreadTestRes threadResEmpty[max_threads];
 	ThreadTestRes threadResNewDel[max_threads];
 	ThreadTestRes threadResPerThreadAlloc[max_threads];
+	ThreadTestRes threadResExternal[max_threads];
+	MemoryFootprintSummary memEmpty;
+	MemoryFootprintSummary memNewDel;
+	MemoryFootprintSummary memPerThreadAlloc;
+	MemoryFootprintSummary memExternal;
 };
 
 struct TestStartupParams
@@ -235,6 +310,39 @@ struct TestStartupParams
 	size_t iterCount;
 	size_t allocatorType;
 	MEM_ACCESS_TYPE mat;
+	size_t latencySampleEvery; // 0 to disable latency sampling
+	SIZE_DISTRIBUTION sizeDistribution;
+	size_t minItemSize; // for SIZE_DISTRIBUTION::uniform
+	LIFETIME_DISTRIBUTION lifetimeDistribution;
+	double paretoSkew;
+	size_t setupFillPercent;
+	size_t maintenanceEvery;
+	uint64_t seed;
+	uint64_t seedThreadStride;
+	LIFETIME_GENERATOR generator;
+	uint32_t sessionEvents;
+	size_t leakEvery;
+
+	void applyWorkload( const WorkloadDescription& w )
+	{
+		iterCount = w.iterCount;
+		maxItemSize = w.maxItemSizeExp;
+		allocatorType = w.allocatorType;
+		mat = w.mat;
+		latencySampleEvery = w.latencySampleEvery;
+		sizeDistribution = w.sizeDistribution;
+		minItemSize = w.minItemSize;
+		lifetimeDistribution = w.lifetimeDistribution;
+		paretoSkew = w.paretoSkew;
+		setupFillPercent = w.setupFillPercent;
+		maintenanceEvery = w.maintenanceEvery;
+		seed = w.seed;
+		seedThreadStride = w.seedThreadStride;
+		generator = w.generator;
+		sessionEvents = (uint32_t)w.sessionEvents;
+		leakEvery = w.leakEvery;
+		calcMod = generator == LIFETIME_GENERATOR::none ? USE_RANDOMPOS_RANDOMSIZE : USE_GENERATED_LIFETIMES;
+	}
 };
 
 struct TestStartupParamsAndResults
@@ -250,168 +358,7 @@ struct ThreadStartupParamsAndResults
 	ThreadTestRes* threadResEmpty;
 	ThreadTestRes* threadResNewDel;
 	ThreadTestRes* threadResPerThreadAlloc;
-};
-
-class NewDeleteUnderTest
-{
-	CommonTestResults* testRes;
-	size_t start;
-
-public:
-	NewDeleteUnderTest( CommonTestResults* testRes_ ) { testRes = testRes_; }
-	static constexpr bool isFake() { return false; }
-	void init( size_t threadID )
-	{
-		start = GetMillisecondCount();
-		testRes->threadID = threadID; // just as received
-		testRes->rdtscBegin = __rdtsc();
-	}
-
-	void* allocate( size_t sz ) { return new uint8_t[ sz ]; }
-	void deallocate( void* ptr ) { delete [] reinterpret_cast<uint8_t*>(ptr); }
-
-	void deinit() {}
-
-	void doWhateverAfterSetupPhase() { testRes->rdtscSetup = __rdtsc(); }
-	void doWhateverWithinMainLoopPhase() {}
-	void doWhateverAfterMainLoopPhase() { testRes->rdtscMainLoop = __rdtsc(); }
-	void doWhateverAfterCleanupPhase()
-	{
-		testRes->rdtscExit = __rdtsc();
-		testRes->innerDur = GetMillisecondCount() - start;
-	}
-};
-
-class PerThreadAllocatorUnderTest
-{
-	ThreadLocalAllocatorT allocManager;
-	ThreadLocalAllocatorT* formerAlloc = nullptr;
-	ThreadTestRes* testRes;
-	size_t start;
-
-public:
-	PerThreadAllocatorUnderTest( ThreadTestRes* testRes_ ) { testRes = testRes_; }
-	static constexpr bool isFake() { return false; }
-
-	void init( size_t threadID )
-	{
-		start = GetMillisecondCount();
-		testRes->rdtscBegin = __rdtsc();
-		allocManager.initialize();
-		formerAlloc = setCurrneAllocator( &allocManager );
-	}
-
-#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
-	void* allocate( size_t sz ) { 
-		void* ret = allocManager.zombieableAllocate( sz ); 
-		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, allocManager.isZombieablePointerInBlock(ret, ret)); 
-		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, !allocManager.isZombieablePointerInBlock(ret, nullptr)); 
-		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, sz == 0 || allocManager.isZombieablePointerInBlock(ret, reinterpret_cast<uint8_t*>(ret) + sz - 1)); 
-		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, sz < 16 || !allocManager.isZombieablePointerInBlock(ret, reinterpret_cast<uint8_t*>(ret) + sz*2)); 
-		return ret; 
-	}
-	void deallocate( void* ptr ) { allocManager.zombieableDeallocate( ptr ); }
-#else
-	void* allocate( size_t sz ) { 
-		void* ret = allocManager.allocate( sz ); 
-		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, allocManager.getAllocatedSize(ret) >= sz); 
-		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, sz < 8 || allocManager.getAllocatedSize(ret) <= sz*2); 
-		return ret; 
-	}
-	void deallocate( void* ptr ) { allocManager.deallocate( ptr ); }
-#endif
-	void deinit()
-	{
-#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
-		allocManager.killAllZombies();
-#endif
-		formerAlloc = setCurrneAllocator( formerAlloc );
-		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, formerAlloc == &allocManager );
-	}
-
-	void doWhateverAfterSetupPhase()
-	{
-#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
-		allocManager.killAllZombies();
-#endif
-		testRes->rdtscSetup = __rdtsc();
-		testRes->rdtscSysAllocCallSumAfterSetup = allocManager.getStats().rdtscSysAllocSpent;
-		testRes->sysAllocCallCntAfterSetup = allocManager.getStats().sysAllocCount;
-		testRes->rdtscSysDeallocCallSumAfterSetup = allocManager.getStats().rdtscSysDeallocSpent;
-		testRes->sysDeallocCallCntAfterSetup = allocManager.getStats().sysDeallocCount;
-		testRes->allocRequestCountAfterSetup = allocManager.getStats().allocRequestCount;
-		testRes->deallocRequestCountAfterSetup = allocManager.getStats().deallocRequestCount;
-	}
-
-	void doWhateverWithinMainLoopPhase()
-	{
-#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
-		allocManager.killAllZombies();
-#endif
-	}
-
-	void doWhateverAfterMainLoopPhase()
-	{
-#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
-		allocManager.killAllZombies();
-#endif
-		testRes->rdtscMainLoop = __rdtsc();
-		testRes->rdtscSysAllocCallSumAfterMainLoop = allocManager.getStats().rdtscSysAllocSpent;
-		testRes->sysAllocCallCntAfterMainLoop = allocManager.getStats().sysAllocCount;
-		testRes->rdtscSysDeallocCallSumAfterMainLoop = allocManager.getStats().rdtscSysDeallocSpent;
-		testRes->sysDeallocCallCntAfterMainLoop = allocManager.getStats().sysDeallocCount;
-		testRes->allocRequestCountAfterMainLoop = allocManager.getStats().allocRequestCount;
-		testRes->deallocRequestCountAfterMainLoop = allocManager.getStats().deallocRequestCount;
-	}
-
-	void doWhateverAfterCleanupPhase()
-	{
-#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
-		allocManager.killAllZombies();
-#endif
-		testRes->rdtscExit = __rdtsc();
-		testRes->rdtscSysAllocCallSumAfterExit = allocManager.getStats().rdtscSysAllocSpent;
-		testRes->sysAllocCallCntAfterExit = allocManager.getStats().sysAllocCount;
-		testRes->rdtscSysDeallocCallSumAfterExit = allocManager.getStats().rdtscSysDeallocSpent;
-		testRes->sysDeallocCallCntAfterExit = allocManager.getStats().sysDeallocCount;
-		testRes->allocRequestCountAfterExit = allocManager.getStats().allocRequestCount;
-		testRes->deallocRequestCountAfterExit = allocManager.getStats().deallocRequestCount;
-		testRes->innerDur = GetMillisecondCount() - start;
-	}
-};
-
-class FakeAllocatorUnderTest
-{
-	CommonTestResults* testRes;
-	size_t start;
-	uint8_t* fakeBuffer = nullptr;
-	static constexpr size_t fakeBufferSize = 0x1000000;
-
-public:
-	FakeAllocatorUnderTest( CommonTestResults* testRes_ ) { testRes = testRes_; }
-	static constexpr bool isFake() { return true; } // thus indicating that certain checks over allocated memory should be ommited
-
-	void init( size_t threadID )
-	{
-		start = GetMillisecondCount();
-		testRes->threadID = threadID; // just as received
-		testRes->rdtscBegin = __rdtsc();
-		fakeBuffer = new uint8_t [fakeBufferSize];
-	}
-
-	void* allocate( size_t sz ) { NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, sz <= fakeBufferSize ); return fakeBuffer; }
-	void deallocate( void* ptr ) {}
-
-	void deinit() { if ( fakeBuffer ) delete [] fakeBuffer; fakeBuffer = nullptr; }
-
-	void doWhateverAfterSetupPhase() { testRes->rdtscSetup = __rdtsc(); }
-	void doWhateverWithinMainLoopPhase() {}
-	void doWhateverAfterMainLoopPhase() { testRes->rdtscMainLoop = __rdtsc(); }
-	void doWhateverAfterCleanupPhase()
-	{
-		testRes->rdtscExit = __rdtsc();
-		testRes->innerDur = GetMillisecondCount() - start;
-	}
+	ThreadTestRes* threadResExternal;
 };
 
 constexpr double Pareto_80_20_6[7] = {
@@ -430,16 +377,38 @@ struct Pareto_80_20_6_Data
 };
 
 NODECPP_FORCEINLINE
-void Pareto_80_20_6_Init( Pareto_80_20_6_Data& data, uint32_t itemCount )
+void Pareto_6_Init( Pareto_80_20_6_Data& data, uint32_t itemCount, const double* probabilities )
 {
-	data.probabilityRanges[0] = (uint32_t)(UINT32_MAX * Pareto_80_20_6[0]);
-	data.probabilityRanges[5] = (uint32_t)(UINT32_MAX * (1. - Pareto_80_20_6[6]));
+	data.probabilityRanges[0] = (uint32_t)(UINT32_MAX * probabilities[0]);
+	data.probabilityRanges[5] = (uint32_t)(UINT32_MAX * (1. - probabilities[6]));
 	for ( size_t i=1; i<5; ++i )
-		data.probabilityRanges[i] = data.probabilityRanges[i-1] + (uint32_t)(UINT32_MAX * Pareto_80_20_6[i]);
+		data.probabilityRanges[i] = data.probabilityRanges[i-1] + (uint32_t)(UINT32_MAX * probabilities[i]);
 	data.offsets[0] = 0;
 	data.offsets[7] = itemCount;
 	for ( size_t i=0; i<6; ++i )
-		data.offsets[i+1] = data.offsets[i] + (uint32_t)(itemCount * Pareto_80_20_6[6-i]);
+		data.offsets[i+1] = data.offsets[i] + (uint32_t)(itemCount * probabilities[6-i]);
+}
+
+NODECPP_FORCEINLINE
+void Pareto_80_20_6_Init( Pareto_80_20_6_Data& data, uint32_t itemCount )
+{
+	Pareto_6_Init( data, itemCount, Pareto_80_20_6 );
+}
+
+// generalization of Pareto_80_20_6 to an arbitrary skew p (0.5 < p < 1): probabilities[k] = C(6,k) * p^(6-k) * (1-p)^k
+NODECPP_FORCEINLINE
+void Pareto_6_Init( Pareto_80_20_6_Data& data, uint32_t itemCount, double skew )
+{
+	if ( skew == 0.8 )
+	{
+		Pareto_80_20_6_Init( data, itemCount );
+		return;
+	}
+	constexpr double binomial6[7] = { 1, 6, 15, 20, 15, 6, 1 };
+	double probabilities[7];
+	for ( int k=0; k<7; ++k )
+		probabilities[k] = binomial6[k] * pow( skew, 6 - k ) * pow( 1 - skew, k );
+	Pareto_6_Init( data, itemCount, probabilities );
 }
 
 NODECPP_FORCEINLINE
@@ -463,20 +432,53 @@ size_t Pareto_80_20_6_Rand( const Pareto_80_20_6_Data& data, uint32_t rnum1, uin
 	return data.offsets[ idx ] + offsetInRange;
 }
 
+NODECPP_FORCEINLINE
+size_t randomItemSize( const TestStartupParams& params )
+{
+	switch ( params.sizeDistribution )
+	{
+		case SIZE_DISTRIBUTION::uniform:
+			return params.minItemSize + rng64() % ( ( (size_t)1 << params.maxItemSize ) - params.minItemSize + 1 );
+		case SIZE_DISTRIBUTION::fixed:
+			return (size_t)1 << params.maxItemSize;
+		default:
+			return calcSizeWithStatsAdjustment( rng64(), params.maxItemSize );
+	}
+}
+
+// bit j is set if slot j out of 32 is to be populated during setup phase
+NODECPP_FORCEINLINE
+uint32_t randomSetupFillMask( size_t fillPercent )
+{
+	if ( fillPercent == 50 )
+		return (uint32_t)( rng64() );
+	uint32_t mask = 0;
+	for ( size_t j=0; j<32; ++j )
+		if ( rng64() % 100 < fillPercent )
+			mask |= 1u << j;
+	return mask;
+}
+
 #if 1
 template< class AllocatorUnderTest, MEM_ACCESS_TYPE mat>
-void randomPos_RandomSize( AllocatorUnderTest& allocatorUnderTest, size_t iterCount, size_t maxItems, size_t maxItemSizeExp, size_t threadID )
+void randomPos_RandomSize( AllocatorUnderTest& allocatorUnderTest, const TestStartupParams& params, size_t threadID )
 {
 	constexpr bool doMemAccess = mat != MEM_ACCESS_TYPE::none;
 	constexpr bool doFullAccess = mat == MEM_ACCESS_TYPE::full;
+	size_t iterCount = params.iterCount;
+	size_t maxItems = params.maxItems;
+	size_t maintenanceEvery = params.maintenanceEvery;
+	bool paretoLifetime = params.lifetimeDistribution == LIFETIME_DISTRIBUTION::pareto;
 //	nodecpp::log::default_log::info( "rnd_seed = {}, iterCount = {}, maxItems = {}, maxItemSizeExp = {}", rnd_seed, iterCount, maxItems, maxItemSizeExp );
+	sampleMemoryFootprint( allocatorUnderTest.testResults()->memBegin );
 	allocatorUnderTest.init( threadID );
 
 	size_t dummyCtr = 0;
+	uint64_t liveBytes = 0; // as requested
 
 	Pareto_80_20_6_Data paretoData;
 	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, maxItems <= UINT32_MAX );
-	Pareto_80_20_6_Init( paretoData, (uint32_t)maxItems );
+	Pareto_6_Init( paretoData, (uint32_t)maxItems, params.paretoSkew );
 
 	size_t start = GetMillisecondCount();
 
@@ -493,18 +495,19 @@ void randomPos_RandomSize( AllocatorUnderTest& allocatorUnderTest, size_t iterCo
 		baseBuff = new TestBin [ maxItems ]; // just using standard allocator
 	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, baseBuff );
 	memset( baseBuff, 0, maxItems * sizeof( TestBin ) );
+	liveBytes += maxItems * sizeof(TestBin);
 
 	// setup (saturation)
 	for ( size_t i=0;i<maxItems/32; ++i )
 	{
-		uint32_t randNum = (uint32_t)( rng64() );
+		uint32_t randNum = randomSetupFillMask( params.setupFillPercent );
 		for ( size_t j=0; j<32; ++j )
 			if ( (randNum >> j) & 1 )
 			{
-				size_t randNumSz = rng64();
-				size_t sz = calcSizeWithStatsAdjustment( randNumSz, maxItemSizeExp );
+				size_t sz = randomItemSize( params );
 				baseBuff[i*32+j].sz = sz;
 				baseBuff[i*32+j].ptr = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( sz ) );
+				liveBytes += sz;
 				if constexpr ( doMemAccess )
 				{
 					if constexpr ( doFullAccess )
@@ -518,17 +521,23 @@ void randomPos_RandomSize( AllocatorUnderTest& allocatorUnderTest, size_t iterCo
 			}
 	}
 	allocatorUnderTest.doWhateverAfterSetupPhase();
+	sampleMemoryFootprint( allocatorUnderTest.testResults()->memAfterSetup );
+	allocatorUnderTest.testResults()->liveBytesAfterSetup = liveBytes;
 
 	// main loop
-	for ( size_t j=0;j<iterCount/10000; ++j )
+	OpLatencyStats* latency = allocatorUnderTest.testResults()->latency;
+	size_t toNextSample = latency ? latency->sampleEvery : 0;
+	for ( size_t j=0;j<iterCount/maintenanceEvery; ++j )
 	{
-		for ( size_t k=0;k<10000; ++k )
+		for ( size_t k=0;k<maintenanceEvery; ++k )
 		{
+			bool doSample = latency != nullptr && --toNextSample == 0;
+			if ( doSample )
+				toNextSample = latency->sampleEvery;
 			size_t randNum = rng64();
-	//		size_t idx = randNum % maxItems;
 			uint32_t rnum1 = (uint32_t)randNum;
 			uint32_t rnum2 = (uint32_t)(randNum >> 32);
-			size_t idx = Pareto_80_20_6_Rand( paretoData, rnum1, rnum2 );
+			size_t idx = paretoLifetime ? Pareto_80_20_6_Rand( paretoData, rnum1, rnum2 ) : randNum % maxItems;
 			if ( baseBuff[idx].ptr )
 			{
 				if constexpr ( doMemAccess )
@@ -548,14 +557,22 @@ void randomPos_RandomSize( AllocatorUnderTest& allocatorUnderTest, size_t iterCo
 						dummyCtr += baseBuff[idx].ptr[baseBuff[idx].sz/2];
 					}
 				}
-				allocatorUnderTest.deallocate( baseBuff[idx].ptr );
+				if ( doSample )
+					sampledDeallocate( allocatorUnderTest, baseBuff[idx].ptr, *latency );
+				else
+					allocatorUnderTest.deallocate( baseBuff[idx].ptr );
 				baseBuff[idx].ptr = 0;
+				liveBytes -= baseBuff[idx].sz;
 			}
 			else
 			{
-				size_t sz = calcSizeWithStatsAdjustment( rng64(), maxItemSizeExp );
+				size_t sz = randomItemSize( params );
 				baseBuff[idx].sz = sz;
-				baseBuff[idx].ptr = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( sz ) );
+				if ( doSample )
+					baseBuff[idx].ptr = reinterpret_cast<uint8_t*>( sampledAllocate( allocatorUnderTest, sz, *latency ) );
+				else
+					baseBuff[idx].ptr = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( sz ) );
+				liveBytes += sz;
 				if constexpr ( doMemAccess )
 				{
 					if constexpr ( doFullAccess )
@@ -568,9 +585,18 @@ void randomPos_RandomSize( AllocatorUnderTest& allocatorUnderTest, size_t iterCo
 				}
 			}
 		}
-		allocatorUnderTest.doWhateverWithinMainLoopPhase();
+		if ( latency )
+		{
+			uint64_t start = __rdtsc();
+			allocatorUnderTest.doWhateverWithinMainLoopPhase();
+			latency->mainLoopMaintenance.record( __rdtsc() - start );
+		}
+		else
+			allocatorUnderTest.doWhateverWithinMainLoopPhase();
 	}
 	allocatorUnderTest.doWhateverAfterMainLoopPhase();
+	sampleMemoryFootprint( allocatorUnderTest.testResults()->memAfterMainLoop );
+	allocatorUnderTest.testResults()->liveBytesAfterMainLoop = liveBytes;
 
 	// exit
 	for ( size_t idx=0; idx<maxItems; ++idx )
@@ -602,6 +628,7 @@ void randomPos_RandomSize( AllocatorUnderTest& allocatorUnderTest, size_t iterCo
 		delete [] baseBuff;
 	allocatorUnderTest.deinit();
 	allocatorUnderTest.doWhateverAfterCleanupPhase();
+	sampleMemoryFootprint( allocatorUnderTest.testResults()->memAfterExit );
 		
 	nodecpp::log::default_log::info( "about to exit thread {} ({} operations performed) [ctr = {}]...", threadID, iterCount, dummyCtr );
 }
@@ -747,6 +774,172 @@ void randomPos_RandomSize( AllocatorUnderTest& allocatorUnderTest, size_t iterCo
 }
 #endif
 
+// Objects are created as dictated by a LifetimeGenerator, event by event; an object with lifetime L created 
+// at event T is deallocated at the end of event T + L (with the objects of each event deallocated in LIFO order).
+// Live objects are tracked in a pool of maxItems slots (objects that do not fit die at the end of their event) 
+// and a timing wheel of slot lists, indexed by event of death.
+template< class AllocatorUnderTest, MEM_ACCESS_TYPE mat>
+void generatedLifetimes( AllocatorUnderTest& allocatorUnderTest, const TestStartupParams& params, size_t threadID )
+{
+	constexpr bool doMemAccess = mat != MEM_ACCESS_TYPE::none;
+	constexpr bool doFullAccess = mat == MEM_ACCESS_TYPE::full;
+	constexpr uint32_t no_slot = UINT32_MAX;
+	constexpr size_t wheelSize = (size_t)LifetimeGenerator::max_lifetime + 1;
+	static_assert( ( wheelSize & ( wheelSize - 1 ) ) == 0, "" );
+	sampleMemoryFootprint( allocatorUnderTest.testResults()->memBegin );
+	allocatorUnderTest.init( threadID );
+
+	size_t dummyCtr = 0;
+	uint64_t liveBytes = 0; // as requested
+	size_t overflowCnt = 0;
+
+	struct Slot
+	{
+		uint8_t* ptr;
+		uint32_t sz;
+		uint32_t next;
+	};
+
+	size_t maxItems = params.maxItems;
+	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, maxItems < no_slot );
+	size_t bookkeepingSize = maxItems * sizeof(Slot) + ( wheelSize + 1 ) * sizeof(uint32_t);
+	uint8_t* bookkeeping = nullptr;
+	if ( !allocatorUnderTest.isFake() )
+		bookkeeping = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( bookkeepingSize ) );
+	else
+		bookkeeping = new uint8_t [ bookkeepingSize ]; // just using standard allocator
+	NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, bookkeeping );
+	liveBytes += bookkeepingSize;
+	Slot* slots = reinterpret_cast<Slot*>( bookkeeping );
+	uint32_t* wheel = reinterpret_cast<uint32_t*>( bookkeeping + maxItems * sizeof(Slot) );
+	uint32_t& immortals = wheel[wheelSize];
+	for ( size_t i=0; i<maxItems; ++i )
+		slots[i].next = i + 1 < maxItems ? (uint32_t)(i + 1) : no_slot;
+	uint32_t freeSlots = 0;
+	for ( size_t i=0; i<=wheelSize; ++i )
+		wheel[i] = no_slot;
+
+	auto rng = []() { return rng64(); };
+	LifetimeGenerator generator( params.generator, (size_t)1 << params.maxItemSize, params.sessionEvents, params.leakEvery );
+	GeneratedAllocation batch[ LifetimeGenerator::max_allocations_per_event ];
+	uint64_t tick = 0;
+
+	auto deallocateList = [&]( uint32_t head ) {
+		while ( head != no_slot )
+		{
+			Slot& slot = slots[head];
+			if constexpr ( doMemAccess )
+			{
+				if constexpr ( doFullAccess )
+				{
+					size_t i=0;
+					for ( ; i<slot.sz/sizeof(size_t ); ++i )
+						dummyCtr += ( reinterpret_cast<size_t*>( slot.ptr) )[i];
+				}
+				else
+				{
+					static_assert( mat == MEM_ACCESS_TYPE::single, "" );
+					dummyCtr += slot.ptr[slot.sz/2];
+				}
+			}
+			allocatorUnderTest.deallocate( slot.ptr );
+			liveBytes -= slot.sz;
+			uint32_t next = slot.next;
+			slot.next = freeSlots;
+			freeSlots = head;
+			head = next;
+		}
+	};
+
+	auto runEvent = [&]() {
+		size_t cnt = generator.nextEvent( rng, batch );
+		uint32_t& dyingNow = wheel[tick & ( wheelSize - 1 )];
+		for ( size_t i=0; i<cnt; ++i )
+		{
+			size_t sz = batch[i].sz;
+			uint8_t* ptr = reinterpret_cast<uint8_t*>( allocatorUnderTest.allocate( sz ) );
+			liveBytes += sz;
+			if constexpr ( doMemAccess )
+			{
+				if constexpr ( doFullAccess )
+					memset( ptr, (uint8_t)sz, sz );
+				else
+				{
+					static_assert( mat == MEM_ACCESS_TYPE::single, "" );
+					ptr[sz/2] = (uint8_t)sz;
+				}
+			}
+			uint32_t idx = freeSlots;
+			if ( idx == no_slot )
+			{
+				allocatorUnderTest.deallocate( ptr );
+				liveBytes -= sz;
+				++overflowCnt;
+				continue;
+			}
+			freeSlots = slots[idx].next;
+			slots[idx].ptr = ptr;
+			slots[idx].sz = (uint32_t)sz;
+			uint32_t& list = batch[i].lifetime == GeneratedAllocation::immortal ? immortals : wheel[( tick + batch[i].lifetime ) & ( wheelSize - 1 )];
+			slots[idx].next = list;
+			list = idx;
+		}
+		uint32_t dying = dyingNow;
+		dyingNow = no_slot;
+		deallocateList( dying );
+		++tick;
+	};
+
+	// setup: populating session generation
+	while ( tick < params.sessionEvents )
+		runEvent();
+	allocatorUnderTest.doWhateverAfterSetupPhase();
+	sampleMemoryFootprint( allocatorUnderTest.testResults()->memAfterSetup );
+	allocatorUnderTest.testResults()->liveBytesAfterSetup = liveBytes;
+
+	// main loop
+	size_t nextMaintenance = generator.allocationCount() + params.maintenanceEvery;
+	size_t endAllocCount = generator.allocationCount() + params.iterCount;
+	while ( generator.allocationCount() < endAllocCount )
+	{
+		runEvent();
+		if ( generator.allocationCount() >= nextMaintenance )
+		{
+			allocatorUnderTest.doWhateverWithinMainLoopPhase();
+			nextMaintenance += params.maintenanceEvery;
+		}
+	}
+	allocatorUnderTest.doWhateverAfterMainLoopPhase();
+	sampleMemoryFootprint( allocatorUnderTest.testResults()->memAfterMainLoop );
+	allocatorUnderTest.testResults()->liveBytesAfterMainLoop = liveBytes;
+
+	// exit
+	for ( size_t i=0; i<wheelSize; ++i )
+		deallocateList( wheel[( tick + i ) & ( wheelSize - 1 )] );
+	deallocateList( immortals );
+
+	if ( !allocatorUnderTest.isFake() )
+		allocatorUnderTest.deallocate( bookkeeping );
+	else
+		delete [] bookkeeping;
+	allocatorUnderTest.deinit();
+	allocatorUnderTest.doWhateverAfterCleanupPhase();
+	sampleMemoryFootprint( allocatorUnderTest.testResults()->memAfterExit );
+
+	if ( overflowCnt )
+		nodecpp::log::default_log::info( "thread {}: {} objects did not fit into {} slots and were deallocated early (consider increasing items.total)", threadID, overflowCnt, maxItems );
+	nodecpp::log::default_log::info( "about to exit thread {} ({} allocations in {} events performed) [ctr = {}]...", threadID, generator.allocationCount(), tick, dummyCtr );
+}
+
+template< class AllocatorUnderTest, MEM_ACCESS_TYPE mat>
+void runTestScenario( AllocatorUnderTest& allocatorUnderTest, const TestStartupParams& params, size_t threadID )
+{
+	if ( params.calcMod == USE_GENERATED_LIFETIMES )
+		generatedLifetimes<AllocatorUnderTest, mat>( allocatorUnderTest, params, threadID );
+	else
+		randomPos_RandomSize<AllocatorUnderTest, mat>( allocatorUnderTest, params, threadID );
+}
+
 
 
 #endif
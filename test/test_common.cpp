@@ -36,14 +36,22 @@
 
 #include <stdint.h>
 #include <assert.h>
+#include <chrono>
+#include <thread>
 
 #if defined NODECPP_WINDOWS
 #include <Windows.h>
+#include <psapi.h>
 #elif defined NODECPP_LINUX
 #include <time.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
 #elif defined NODECPP_MAC
 #include <mach/clock.h>
 #include <mach/mach.h>
+#include <sys/resource.h>
 #endif
 
 
@@ -129,3 +137,119 @@ size_t GetMillisecondCount()
 #error unknown/unsupported OS
 
 #endif
+
+
+double rdtscToNanoseconds( uint64_t ticks )
+{
+	static double nsPerTick = 0;
+	if ( nsPerTick == 0 )
+	{
+		auto clockStart = std::chrono::steady_clock::now();
+		uint64_t rdtscStart = NODECPP_RDTSC();
+		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+		uint64_t rdtscEnd = NODECPP_RDTSC();
+		auto clockEnd = std::chrono::steady_clock::now();
+		int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( clockEnd - clockStart ).count();
+		NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, rdtscEnd > rdtscStart && ns > 0 );
+		nsPerTick = ns * 1. / ( rdtscEnd - rdtscStart );
+	}
+	return ticks * nsPerTick;
+}
+
+#if defined NODECPP_WINDOWS
+void sampleMemoryFootprint( MemoryFootprint& mf )
+{
+	memset( &mf, 0, sizeof( MemoryFootprint ) );
+	PROCESS_MEMORY_COUNTERS pmc;
+	if ( GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof( pmc ) ) )
+	{
+		mf.vmSize = pmc.PagefileUsage;
+		mf.rss = pmc.WorkingSetSize;
+		mf.peakRss = pmc.PeakWorkingSetSize;
+		mf.minorFaults = pmc.PageFaultCount;
+	}
+}
+
+bool resetPeakRss() { return false; }
+
+#elif defined NODECPP_LINUX
+static size_t readPeakRssFromProcStatus()
+{
+	FILE* f = fopen( "/proc/self/status", "r" );
+	if ( f == nullptr )
+		return 0;
+	char line[ 256 ];
+	size_t ret = 0;
+	while ( fgets( line, sizeof( line ), f ) )
+		if ( strncmp( line, "VmHWM:", 6 ) == 0 )
+		{
+			ret = strtoull( line + 6, nullptr, 10 ) * 1024; // in kB
+			break;
+		}
+	fclose( f );
+	return ret;
+}
+
+void sampleMemoryFootprint( MemoryFootprint& mf )
+{
+	memset( &mf, 0, sizeof( MemoryFootprint ) );
+	size_t pageSize = sysconf( _SC_PAGESIZE );
+	FILE* f = fopen( "/proc/self/statm", "r" );
+	if ( f )
+	{
+		unsigned long long vmPages = 0, rssPages = 0;
+		if ( fscanf( f, "%llu %llu", &vmPages, &rssPages ) == 2 )
+		{
+			mf.vmSize = vmPages * pageSize;
+			mf.rss = rssPages * pageSize;
+		}
+		fclose( f );
+	}
+	struct rusage usage;
+	if ( getrusage( RUSAGE_SELF, &usage ) == 0 )
+	{
+		mf.peakRss = usage.ru_maxrss * 1024; // in kB
+		mf.minorFaults = usage.ru_minflt;
+		mf.majorFaults = usage.ru_majflt;
+	}
+	// unlike ru_maxrss, VmHWM can be reset (see resetPeakRss())
+	size_t hwm = readPeakRssFromProcStatus();
+	if ( hwm )
+		mf.peakRss = hwm;
+}
+
+bool resetPeakRss()
+{
+	FILE* f = fopen( "/proc/self/clear_refs", "w" );
+	if ( f == nullptr )
+		return false;
+	bool ret = fputs( "5", f ) >= 0;
+	ret = ( fclose( f ) == 0 ) && ret;
+	return ret;
+}
+
+#elif defined NODECPP_MAC
+void sampleMemoryFootprint( MemoryFootprint& mf )
+{
+	memset( &mf, 0, sizeof( MemoryFootprint ) );
+	mach_task_basic_info info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if ( task_info( mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count ) == KERN_SUCCESS )
+	{
+		mf.vmSize = info.virtual_size;
+		mf.rss = info.resident_size;
+	}
+	struct rusage usage;
+	if ( getrusage( RUSAGE_SELF, &usage ) == 0 )
+	{
+		mf.peakRss = usage.ru_maxrss; // in bytes
+		mf.minorFaults = usage.ru_minflt;
+		mf.majorFaults = usage.ru_majflt;
+	}
+}
+
+bool resetPeakRss() { return false; }
+
+#else // other OSs
+#error unknown/unsupported OS
+#endif
@@ -45,4 +45,20 @@ using namespace nodecpp::iibmalloc;
 int64_t GetMicrosecondCount();
 size_t GetMillisecondCount();
 
+// RDTSC ticks are calibrated against a steady clock once per process (on first call)
+double rdtscToNanoseconds( uint64_t ticks );
+
+// process-wide memory footprint (all sizes are in bytes); values not available on a given platform are set to 0
+struct MemoryFootprint
+{
+	size_t vmSize;
+	size_t rss;
+	size_t peakRss; // since process start, or since a last call to resetPeakRss() where supported
+	size_t minorFaults;
+	size_t majorFaults;
+};
+
+void sampleMemoryFootprint( MemoryFootprint& mf );
+bool resetPeakRss(); // returns false if not supported on a given platform
+
 #endif // ALLOCATOR_TEST_COMMON_H
\ No newline at end of file
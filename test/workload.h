@@ -0,0 +1,330 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Workload descriptions for the random test: a plain-text file of key = value lines 
+ *     that fully determines a test run (see test/workloads/ for named scenarios)
+ * 
+ * -------------------------------------------------------------------------------*/
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "allocator_under_test.h"
+#include "lifetime_generators.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+enum class SIZE_DISTRIBUTION { stats_adjusted, uniform, fixed };
+enum class LIFETIME_DISTRIBUTION { pareto, uniform };
+enum MEM_ACCESS_TYPE { none, single, full };
+
+// Recognized keys (all optional; defaults reproduce the original hardcoded random test):
+//   name = <text>                       for logging only
+//   threads.min = <n>, threads.max = <n> the test is run for each thread count in [min, max]
+//   items.total = <n>                   number of item slots, divided between threads
+//   iterations = <n>                    main loop operations per thread
+//   size.distribution = stats-adjusted | uniform | fixed
+//   size.maxExp = <n>                   max item size is 2^n (fixed: size is 2^n)
+//   size.min = <n>                      min item size for the uniform distribution
+//   lifetime.distribution = pareto | uniform   how slots to be toggled (allocated or deallocated) are selected;
+//                                       with pareto, items in hot slots are short-lived, and in cold ones, long-lived
+//   lifetime.paretoSkew = <p>           0.5 < p < 1; 0.8 stands for 80/20
+//   memAccess = none | single | full
+//   phase.setupFill = <percent>         share of slots populated during setup phase
+//   phase.maintenanceEvery = <n>        main loop operations between doWhateverWithinMainLoopPhase() calls
+//   seed = <n>, seed.threadStride = <n> seed of thread i is seed + i * threadStride
+//   generator = none | generational | request-response | string-heavy | slow-leak
+//                                       if other than none, objects are allocated by a LifetimeGenerator (see lifetime_generators.h)
+//                                       rather than at random positions; lifetime.*, phase.setupFill and size.distribution are then ignored,
+//                                       iterations is a number of allocations, and items.total bounds the number of live objects
+//   generator.sessionEvents = <n>       max lifetime of session objects, in events; also, a number of events in setup phase
+//   generator.leakEvery = <n>           for slow-leak, each n-th allocation is never freed (until thread exit)
+//   allocators = all | <comma-separated list of: empty, new-delete, per-thread, external>
+//   latencySampleEvery = <n>            0 to disable latency sampling
+struct WorkloadDescription
+{
+	char name[64] = "default";
+	size_t threadCountMin = 1;
+	size_t threadCountMax = 1;
+	size_t totalItems = 1 << 25;
+	size_t iterCount = 100000;
+	SIZE_DISTRIBUTION sizeDistribution = SIZE_DISTRIBUTION::stats_adjusted;
+	size_t maxItemSizeExp = 16;
+	size_t minItemSize = 1;
+	LIFETIME_DISTRIBUTION lifetimeDistribution = LIFETIME_DISTRIBUTION::pareto;
+	double paretoSkew = 0.8;
+	MEM_ACCESS_TYPE mat = MEM_ACCESS_TYPE::full;
+	size_t setupFillPercent = 50;
+	size_t maintenanceEvery = 10000;
+	uint64_t seed = 0;
+	uint64_t seedThreadStride = 0;
+	size_t allocatorType = USE_PER_THREAD_ALLOCATOR;
+	size_t latencySampleEvery = 0;
+	LIFETIME_GENERATOR generator = LIFETIME_GENERATOR::none;
+	size_t sessionEvents = 10000;
+	size_t leakEvery = 1000;
+
+	static const char* sizeDistributionName( SIZE_DISTRIBUTION d )
+	{
+		switch ( d )
+		{
+			case SIZE_DISTRIBUTION::stats_adjusted: return "stats-adjusted";
+			case SIZE_DISTRIBUTION::uniform: return "uniform";
+			case SIZE_DISTRIBUTION::fixed: return "fixed";
+		}
+		return "unknown";
+	}
+	static const char* lifetimeDistributionName( LIFETIME_DISTRIBUTION d ) { return d == LIFETIME_DISTRIBUTION::pareto ? "pareto" : "uniform"; }
+	static const char* generatorName( LIFETIME_GENERATOR g )
+	{
+		switch ( g )
+		{
+			case LIFETIME_GENERATOR::none: return "none";
+			case LIFETIME_GENERATOR::generational: return "generational";
+			case LIFETIME_GENERATOR::request_response: return "request-response";
+			case LIFETIME_GENERATOR::string_heavy: return "string-heavy";
+			case LIFETIME_GENERATOR::slow_leak: return "slow-leak";
+		}
+		return "unknown";
+	}
+	static const char* memAccessName( MEM_ACCESS_TYPE mat ) { return mat == MEM_ACCESS_TYPE::none ? "none" : ( mat == MEM_ACCESS_TYPE::single ? "single" : "full" ); }
+
+	void print() const
+	{
+		nodecpp::log::default_log::info( "workload \"{}\": threads = {}..{}, items.total = {}, iterations = {}, size = {} (maxExp = {}, min = {}), lifetime = {} (skew = {}), memAccess = {}, setupFill = {}%, maintenanceEvery = {}, seed = {} (threadStride = {}), allocators = 0x{:x}, latencySampleEvery = {}, generator = {} (sessionEvents = {}, leakEvery = {})",
+			name, threadCountMin, threadCountMax, totalItems, iterCount, sizeDistributionName( sizeDistribution ), maxItemSizeExp, minItemSize, 
+			lifetimeDistributionName( lifetimeDistribution ), paretoSkew, memAccessName( mat ), setupFillPercent, maintenanceEvery, seed, seedThreadStride, allocatorType, latencySampleEvery, 
+			generatorName( generator ), sessionEvents, leakEvery );
+	}
+
+	bool validate() const
+	{
+		if ( threadCountMin == 0 || threadCountMin > threadCountMax || threadCountMax >= max_workload_threads )
+			return error( "threads.min/threads.max", "out of range" );
+		if ( totalItems < 32 * threadCountMax || totalItems / threadCountMin > UINT32_MAX )
+			return error( "items.total", "out of range" );
+		if ( maxItemSizeExp < 3 || maxItemSizeExp > 30 )
+			return error( "size.maxExp", "must be within [3, 30]" );
+		if ( minItemSize == 0 || minItemSize > ( (size_t)1 << maxItemSizeExp ) )
+			return error( "size.min", "must be within [1, 2^size.maxExp]" );
+		if ( !( paretoSkew > 0.5 && paretoSkew < 1 ) )
+			return error( "lifetime.paretoSkew", "must be within (0.5, 1)" );
+		if ( lifetimeDistribution == LIFETIME_DISTRIBUTION::pareto && (double)( totalItems / threadCountMax ) * pow( 1 - paretoSkew, 6 ) < 1 )
+			return error( "items.total", "too few items per thread for the coldest range of lifetime.paretoSkew" );
+		if ( setupFillPercent > 100 )
+			return error( "phase.setupFill", "must be within [0, 100]" );
+		if ( sessionEvents == 0 || sessionEvents > LifetimeGenerator::max_lifetime )
+			return error( "generator.sessionEvents", "out of range" );
+		if ( maintenanceEvery == 0 )
+			return error( "phase.maintenanceEvery", "must be positive" );
+		return true;
+	}
+
+	bool load( const char* path )
+	{
+		FILE* f = fopen( path, "r" );
+		if ( f == nullptr )
+		{
+			nodecpp::log::default_log::info( "failed to open workload file {}", path );
+			return false;
+		}
+		char line[ 512 ];
+		size_t lineNo = 0;
+		bool ok = true;
+		while ( ok && fgets( line, sizeof( line ), f ) )
+		{
+			++lineNo;
+			char* comment = strchr( line, '#' );
+			if ( comment )
+				*comment = 0;
+			char* key = trim( line );
+			if ( *key == 0 )
+				continue;
+			char* eq = strchr( key, '=' );
+			if ( eq == nullptr )
+			{
+				nodecpp::log::default_log::info( "{}:{}: 'key = value' expected", path, lineNo );
+				ok = false;
+				break;
+			}
+			*eq = 0;
+			key = trim( key );
+			char* value = trim( eq + 1 );
+			ok = set( key, value );
+			if ( !ok )
+				nodecpp::log::default_log::info( "{}:{}: failed to parse \"{}\"", path, lineNo, key );
+		}
+		fclose( f );
+		return ok && validate();
+	}
+
+private:
+	static constexpr size_t max_workload_threads = 32; // see max_threads in random_test.h
+
+	static bool error( const char* key, const char* what )
+	{
+		nodecpp::log::default_log::info( "workload: {}: {}", key, what );
+		return false;
+	}
+
+	static char* trim( char* str )
+	{
+		while ( *str == ' ' || *str == '\t' )
+			++str;
+		size_t len = strlen( str );
+		while ( len && ( str[len-1] == ' ' || str[len-1] == '\t' || str[len-1] == '\r' || str[len-1] == '\n' ) )
+			str[--len] = 0;
+		return str;
+	}
+
+	template<class UintT>
+	static bool parseUint( const char* value, UintT& ret )
+	{
+		char* end;
+		ret = (UintT)strtoull( value, &end, 0 );
+		return end != value && *end == 0;
+	}
+
+	bool parseAllocators( char* value )
+	{
+		if ( strcmp( value, "all" ) == 0 )
+		{
+			allocatorType = TRY_ALL;
+			return true;
+		}
+		allocatorType = 0;
+		for ( char* item = strtok( value, "," ); item; item = strtok( nullptr, "," ) )
+		{
+			item = trim( item );
+			if ( strcmp( item, "empty" ) == 0 )
+				allocatorType |= USE_EMPTY_TEST;
+			else if ( strcmp( item, "new-delete" ) == 0 )
+				allocatorType |= USE_NEW_DELETE;
+			else if ( strcmp( item, "per-thread" ) == 0 )
+				allocatorType |= USE_PER_THREAD_ALLOCATOR;
+			else if ( strcmp( item, "external" ) == 0 )
+				allocatorType |= USE_EXTERNAL_MALLOC;
+			else
+				return false;
+		}
+		return allocatorType != 0;
+	}
+
+	bool set( const char* key, char* value )
+	{
+		if ( strcmp( key, "name" ) == 0 )
+		{
+			snprintf( name, sizeof( name ), "%s", value );
+			return true;
+		}
+		if ( strcmp( key, "threads.min" ) == 0 )
+			return parseUint( value, threadCountMin );
+		if ( strcmp( key, "threads.max" ) == 0 )
+			return parseUint( value, threadCountMax );
+		if ( strcmp( key, "items.total" ) == 0 )
+			return parseUint( value, totalItems );
+		if ( strcmp( key, "iterations" ) == 0 )
+			return parseUint( value, iterCount );
+		if ( strcmp( key, "size.distribution" ) == 0 )
+		{
+			if ( strcmp( value, "stats-adjusted" ) == 0 )
+				sizeDistribution = SIZE_DISTRIBUTION::stats_adjusted;
+			else if ( strcmp( value, "uniform" ) == 0 )
+				sizeDistribution = SIZE_DISTRIBUTION::uniform;
+			else if ( strcmp( value, "fixed" ) == 0 )
+				sizeDistribution = SIZE_DISTRIBUTION::fixed;
+			else
+				return false;
+			return true;
+		}
+		if ( strcmp( key, "size.maxExp" ) == 0 )
+			return parseUint( value, maxItemSizeExp );
+		if ( strcmp( key, "size.min" ) == 0 )
+			return parseUint( value, minItemSize );
+		if ( strcmp( key, "lifetime.distribution" ) == 0 )
+		{
+			if ( strcmp( value, "pareto" ) == 0 )
+				lifetimeDistribution = LIFETIME_DISTRIBUTION::pareto;
+			else if ( strcmp( value, "uniform" ) == 0 )
+				lifetimeDistribution = LIFETIME_DISTRIBUTION::uniform;
+			else
+				return false;
+			return true;
+		}
+		if ( strcmp( key, "lifetime.paretoSkew" ) == 0 )
+		{
+			char* end;
+			paretoSkew = strtod( value, &end );
+			return end != value && *end == 0;
+		}
+		if ( strcmp( key, "memAccess" ) == 0 )
+		{
+			if ( strcmp( value, "none" ) == 0 )
+				mat = MEM_ACCESS_TYPE::none;
+			else if ( strcmp( value, "single" ) == 0 )
+				mat = MEM_ACCESS_TYPE::single;
+			else if ( strcmp( value, "full" ) == 0 )
+				mat = MEM_ACCESS_TYPE::full;
+			else
+				return false;
+			return true;
+		}
+		if ( strcmp( key, "phase.setupFill" ) == 0 )
+			return parseUint( value, setupFillPercent );
+		if ( strcmp( key, "phase.maintenanceEvery" ) == 0 )
+			return parseUint( value, maintenanceEvery );
+		if ( strcmp( key, "seed" ) == 0 )
+			return parseUint( value, seed );
+		if ( strcmp( key, "seed.threadStride" ) == 0 )
+			return parseUint( value, seedThreadStride );
+		if ( strcmp( key, "generator" ) == 0 )
+		{
+			static constexpr LIFETIME_GENERATOR generators[] = { LIFETIME_GENERATOR::none, LIFETIME_GENERATOR::generational, LIFETIME_GENERATOR::request_response, LIFETIME_GENERATOR::string_heavy, LIFETIME_GENERATOR::slow_leak };
+			for ( LIFETIME_GENERATOR g : generators )
+				if ( strcmp( value, generatorName( g ) ) == 0 )
+				{
+					generator = g;
+					return true;
+				}
+			return false;
+		}
+		if ( strcmp( key, "generator.sessionEvents" ) == 0 )
+			return parseUint( value, sessionEvents );
+		if ( strcmp( key, "generator.leakEvery" ) == 0 )
+			return parseUint( value, leakEvery );
+		if ( strcmp( key, "allocators" ) == 0 )
+			return parseAllocators( value );
+		if ( strcmp( key, "latencySampleEvery" ) == 0 )
+			return parseUint( value, latencySampleEvery );
+		return false;
+	}
+};
+
+#endif // WORKLOAD_H
@@ -0,0 +1,368 @@
+ /* -------------------------------------------------------------------------------
+ * Copyright (c) 2021, OLogN Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the OLogN Technologies AG nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL OLogN Technologies AG BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * -------------------------------------------------------------------------------
+ * 
+ * Per-thread bucket allocator
+ * Cost of safe-memory means: IibAllocatorBase vs. SafeIibAllocator (zombieableAllocate()/zombieableDeallocate()), 
+ *     with zombie access early detection on and off, for various killAllZombies() intervals and isPointerNotZombie() call rates, 
+ *     and with incremental (advanceZombieEpoch()/releaseZombies()) or automatic (setQuarantineBudget()) release of zombies instead of killAllZombies(); 
+ *     and with interior pages of large zombies discarded or protected (setLargeZombieMode()); 
+ *     reports throughput, latency of killAllZombies() (or releaseZombies()), memory held in quarantine (zombies not yet killed), and RSS growth
+ * 
+ * -------------------------------------------------------------------------------*/
+
+
+#include "test_common.h"
+#include "latency_histogram.h"
+
+#include <memory>
+#include <cstring>
+
+#ifdef NODECPP_MSVC
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#ifndef NODECPP_DISABLE_SAFE_ALLOCATION_MEANS
+
+struct ZombieBenchmarkConfig
+{
+	const char* name;
+	bool safe;
+	bool earlyDetection;
+	size_t killEvery; // operations between killAllZombies() calls (or between advanceZombieEpoch() calls, if releaseBudget or quarantineBudget is not 0)
+	size_t checkEvery; // operations between isPointerNotZombie() calls; 0 for no checks
+	size_t releaseBudget; // if not 0, max number of zombies per releaseZombies() call made every zombie_benchmark_release_every operations
+	size_t quarantineBudget; // if not 0, bytes passed to setQuarantineBudget()
+	SafeIibAllocator::LargeZombieMode largeZombieMode;
+	bool fullAccess; // if true, whole allocated memory is written (by default, only the first byte is)
+	bool smallObjects; // if true, all sizes are within [8, 64] (see zombieBenchmarkSmallSize())
+
+	bool killsZombies() const { return releaseBudget == 0 && quarantineBudget == 0; }
+};
+
+struct ZombieBenchmarkResult
+{
+	size_t dur;
+	uint64_t opCount;
+	uint64_t checkCount;
+	uint64_t dummyCtr;
+	uint64_t peakQuarantineBytes;
+	uint64_t quarantineBytesAtKillSum; // to calculate average quarantine size at killAllZombies() (or advanceZombieEpoch()) calls
+	uint64_t autoReleasedZombieCount;
+	uint64_t quarantineSampleCount;
+	size_t committedAfterMainLoop;
+	size_t rssBefore; // before allocator creation
+	uint64_t rssGrowthAtKillSum; // sampled along with quarantine size (time spent on sampling is excluded from dur)
+	LatencyHistogram killLatency; // of killAllZombies() or releaseZombies(), whichever is used
+
+	double avgQuarantineBytes() const { return quarantineSampleCount ? quarantineBytesAtKillSum * 1. / quarantineSampleCount : 0; }
+	double avgRssGrowth() const { return quarantineSampleCount ? rssGrowthAtKillSum * 1. / quarantineSampleCount : 0; }
+};
+
+struct BaseAllocatorAdapter
+{
+	IibAllocatorBase allocator;
+	NODECPP_FORCEINLINE void* allocate( size_t sz ) { return allocator.allocate( sz ); }
+	NODECPP_FORCEINLINE void deallocate( void* ptr ) { allocator.deallocate( ptr ); }
+	NODECPP_FORCEINLINE bool isPointerNotZombie( void* ptr ) { return true; }
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+	NODECPP_FORCEINLINE SafeIibAllocator::SlotGeneration getSlotGeneration( void* ptr ) { return 0; }
+	NODECPP_FORCEINLINE bool isPointerNotZombie( void* ptr, SafeIibAllocator::SlotGeneration generation ) { return true; }
+#endif // NODECPP_USE_SLOT_GENERATIONS
+	void killAllZombies() {}
+	uint64_t getZombieEpoch() const { return 0; }
+	uint64_t advanceZombieEpoch() { return 0; }
+	size_t releaseZombies( uint64_t epoch, size_t budget ) { return 0; }
+	QuarantineStats getQuarantineStats() const { return QuarantineStats(); }
+	size_t getCommittedSize() const { return allocator.getCommittedSize(); }
+};
+
+struct SafeAllocatorAdapter
+{
+	SafeIibAllocator allocator;
+	SafeAllocatorAdapter( bool earlyDetection, size_t quarantineBudget, SafeIibAllocator::LargeZombieMode largeZombieMode )
+	{
+		allocator.setLargeZombieMode( largeZombieMode );
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+		allocator.doZombieEarlyDetection( earlyDetection );
+#endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+		allocator.setQuarantineBudget( quarantineBudget );
+	}
+	NODECPP_FORCEINLINE void* allocate( size_t sz ) { return allocator.zombieableAllocate( sz ); }
+	NODECPP_FORCEINLINE void deallocate( void* ptr ) { allocator.zombieableDeallocate( ptr ); }
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+	NODECPP_FORCEINLINE bool isPointerNotZombie( void* ptr ) { return allocator.isPointerNotZombie( ptr ); }
+#else
+	NODECPP_FORCEINLINE bool isPointerNotZombie( void* ptr ) { return true; }
+#endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+	NODECPP_FORCEINLINE SafeIibAllocator::SlotGeneration getSlotGeneration( void* ptr ) { return allocator.getSlotGeneration( ptr ); }
+	NODECPP_FORCEINLINE bool isPointerNotZombie( void* ptr, SafeIibAllocator::SlotGeneration generation ) { return allocator.isPointerNotZombie( ptr, generation ); }
+#endif // NODECPP_USE_SLOT_GENERATIONS
+	void killAllZombies() { allocator.killAllZombies(); }
+	uint64_t getZombieEpoch() const { return allocator.getZombieEpoch(); }
+	uint64_t advanceZombieEpoch() { return allocator.advanceZombieEpoch(); }
+	size_t releaseZombies( uint64_t epoch, size_t budget ) { return allocator.releaseZombies( epoch, budget ); }
+	QuarantineStats getQuarantineStats() const { return allocator.getQuarantineStats(); }
+	size_t getCommittedSize() const { return allocator.getCommittedSize(); }
+};
+
+NODECPP_FORCEINLINE uint32_t zombieBenchmarkRandom( uint32_t& x )
+{
+	/* Algorithm "xor" from p. 4 of Marsaglia, "Xorshift RNGs" */
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+// ~90% of sizes are within [16, 512), ~9% within [512, 8K), and ~1% within [8K, 64K) (that is, go to bulk allocator)
+NODECPP_FORCEINLINE size_t zombieBenchmarkSize( uint32_t r )
+{
+	uint32_t kind = r % 100;
+	r >>= 8;
+	if ( kind < 90 )
+		return 16 + r % 496;
+	else if ( kind < 99 )
+		return 512 + r % ( 8192 - 512 );
+	else
+		return 8192 + r % ( 65536 - 8192 );
+}
+
+// for workloads dominated by small objects, where a per-allocation prefix (see NODECPP_DISABLE_ZOMBIE_PREFIX) costs most
+NODECPP_FORCEINLINE size_t zombieBenchmarkSmallSize( uint32_t r )
+{
+	return 8 + ( r >> 8 ) % 57;
+}
+
+constexpr size_t zombie_benchmark_slot_count = 0x10000; // power of 2
+constexpr size_t zombie_benchmark_iterations = 2000000;
+constexpr size_t zombie_benchmark_release_every = 100; // operations between releaseZombies() calls
+
+template<class Adapter>
+void runZombieBenchmark( Adapter& adapter, const ZombieBenchmarkConfig& config, ZombieBenchmarkResult& res )
+{
+	struct Slot
+	{
+		uint8_t* ptr;
+		size_t sz;
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+		SafeIibAllocator::SlotGeneration generation; // as a safe pointer would keep it
+#endif // NODECPP_USE_SLOT_GENERATIONS
+	};
+	std::unique_ptr<Slot[]> slots( new Slot[ zombie_benchmark_slot_count ] );
+	memset( slots.get(), 0, sizeof( Slot ) * zombie_benchmark_slot_count );
+	uint32_t rng = 0x12345678;
+	size_t toNextKill = config.killEvery;
+	size_t toNextCheck = config.checkEvery;
+	size_t toNextRelease = zombie_benchmark_release_every;
+
+	size_t start = GetMillisecondCount();
+	size_t samplingDur = 0;
+	for ( size_t i=0; i<zombie_benchmark_iterations; ++i )
+	{
+		uint32_t r = zombieBenchmarkRandom( rng );
+		Slot& slot = slots[ r & ( zombie_benchmark_slot_count - 1 ) ];
+		if ( slot.ptr )
+		{
+			res.dummyCtr += slot.ptr[0];
+			adapter.deallocate( slot.ptr );
+			slot.ptr = nullptr;
+		}
+		else
+		{
+			slot.sz = config.smallObjects ? zombieBenchmarkSmallSize( zombieBenchmarkRandom( rng ) ) : zombieBenchmarkSize( zombieBenchmarkRandom( rng ) );
+			slot.ptr = reinterpret_cast<uint8_t*>( adapter.allocate( slot.sz ) );
+#ifdef NODECPP_USE_SLOT_GENERATIONS
+			slot.generation = adapter.getSlotGeneration( slot.ptr );
+#endif // NODECPP_USE_SLOT_GENERATIONS
+			if ( config.fullAccess )
+				memset( slot.ptr, (uint8_t)i, slot.sz );
+			else
+				slot.ptr[0] = (uint8_t)i;
+		}
+		++(res.opCount);
+
+		if ( config.checkEvery && --toNextCheck == 0 )
+		{
+			toNextCheck = config.checkEvery;
+			Slot& other = slots[ ( r >> 16 ) & ( zombie_benchmark_slot_count - 1 ) ];
+			if ( other.ptr )
+			{
+#ifndef NODECPP_USE_SLOT_GENERATIONS
+				bool ok = adapter.isPointerNotZombie( other.ptr + other.sz / 2 );
+#else
+				bool ok = adapter.isPointerNotZombie( other.ptr, other.generation );
+#endif // NODECPP_USE_SLOT_GENERATIONS
+				NODECPP_ASSERT(nodecpp::iibmalloc::module_id, nodecpp::assert::AssertLevel::critical, ok );
+				res.dummyCtr += ok;
+				++(res.checkCount);
+			}
+		}
+
+		if ( config.safe && --toNextKill == 0 )
+		{
+			toNextKill = config.killEvery;
+			res.quarantineBytesAtKillSum += adapter.getQuarantineStats().currentSize;
+			++(res.quarantineSampleCount);
+			size_t samplingStart = GetMillisecondCount();
+			MemoryFootprint mf;
+			sampleMemoryFootprint( mf );
+			res.rssGrowthAtKillSum += mf.rss > res.rssBefore ? mf.rss - res.rssBefore : 0;
+			samplingDur += GetMillisecondCount() - samplingStart;
+			if ( config.killsZombies() )
+			{
+				uint64_t killStart = __rdtsc();
+				adapter.killAllZombies();
+				res.killLatency.record( __rdtsc() - killStart );
+			}
+			else
+				adapter.advanceZombieEpoch();
+		}
+
+		if ( config.releaseBudget && --toNextRelease == 0 )
+		{
+			toNextRelease = zombie_benchmark_release_every;
+			// zombies stay in quarantine for at least one complete epoch
+			uint64_t releaseBefore = adapter.getZombieEpoch() - 1;
+			uint64_t releaseStart = __rdtsc();
+			adapter.releaseZombies( releaseBefore, config.releaseBudget );
+			res.killLatency.record( __rdtsc() - releaseStart );
+		}
+	}
+	res.dur = GetMillisecondCount() - start - samplingDur;
+	QuarantineStats qstats = adapter.getQuarantineStats();
+	res.peakQuarantineBytes = qstats.peakSize;
+	res.autoReleasedZombieCount = qstats.autoReleasedZombieCount;
+	res.committedAfterMainLoop = adapter.getCommittedSize();
+
+	for ( size_t i=0; i<zombie_benchmark_slot_count; ++i )
+		if ( slots[i].ptr )
+			adapter.deallocate( slots[i].ptr );
+	adapter.killAllZombies();
+}
+
+void printZombieBenchmarkResult( const ZombieBenchmarkConfig& config, const ZombieBenchmarkResult& res, const ZombieBenchmarkResult& baseRes )
+{
+	double opsPerSec = res.dur ? res.opCount * 1000. / res.dur : 0;
+	double baseOpsPerSec = baseRes.dur ? baseRes.opCount * 1000. / baseRes.dur : 0;
+	nodecpp::log::default_log::info( "{}: {} ops ({} zombie checks) in {} ms, {:.0f} ops/s, {:.2f} of IibAllocatorBase throughput; quarantine: avg {} KB, peak {} KB, {} zombies auto-released; committed {} KB, avg RSS growth {} KB [ctr = {}]", 
+		config.name, res.opCount, res.checkCount, res.dur, opsPerSec, baseOpsPerSec ? opsPerSec / baseOpsPerSec : 0., 
+		(uint64_t)res.avgQuarantineBytes() >> 10, res.peakQuarantineBytes >> 10, res.autoReleasedZombieCount, res.committedAfterMainLoop >> 10, (uint64_t)res.avgRssGrowth() >> 10, res.dummyCtr );
+	if ( res.killLatency.count() )
+		printLatencyPercentiles( config.killsZombies() ? "    killAllZombies(): " : "    releaseZombies(): ", res.killLatency );
+}
+
+int main()
+{
+	nodecpp::log::Log log;
+	log.level = nodecpp::log::LogLevel::info;
+	log.add( stdout );
+	nodecpp::logging_impl::currentLog = &log;
+
+	rdtscToNanoseconds( 1 ); // calibrate
+
+	ZombieBenchmarkConfig configs[] = {
+		{ "IibAllocatorBase", false, false, 0, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection off, kill every 1000", true, false, 1000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection off, kill every 10000", true, false, 10000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection off, kill every 100000", true, false, 100000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection off, epoch every 10000, release by 64", true, false, 10000, 0, 64, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection off, epoch every 100000, release by 64", true, false, 100000, 0, 64, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection off, epoch every 1000, quarantine budget 1MB", true, false, 1000, 0, 0, 1 << 20, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection off, kill every 10000, full access", true, false, 10000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, true, false },
+		{ "SafeIibAllocator, early detection off, kill every 10000, full access, large zombies discarded", true, false, 10000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::discard, true, false },
+		{ "SafeIibAllocator, early detection off, kill every 10000, full access, large zombies protected", true, false, 10000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::protect, true, false },
+		{ "IibAllocatorBase, small objects", false, false, 0, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, true },
+		{ "SafeIibAllocator, early detection off, kill every 10000, small objects", true, false, 10000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, true },
+#ifndef NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+		{ "SafeIibAllocator, early detection on, kill every 1000, no checks", true, true, 1000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, kill every 1000, check every 16", true, true, 1000, 16, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, kill every 1000, check every op", true, true, 1000, 1, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, kill every 10000, no checks", true, true, 10000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, kill every 10000, check every 16", true, true, 10000, 16, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, kill every 10000, check every op", true, true, 10000, 1, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, kill every 100000, no checks", true, true, 100000, 0, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, kill every 100000, check every 16", true, true, 100000, 16, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, kill every 100000, check every op", true, true, 100000, 1, 0, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, epoch every 10000, release by 64, check every 16", true, true, 10000, 16, 64, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, epoch every 100000, release by 64, check every 16", true, true, 100000, 16, 64, 0, SafeIibAllocator::LargeZombieMode::keep, false, false },
+		{ "SafeIibAllocator, early detection on, epoch every 1000, quarantine budget 1MB, check every 16", true, true, 1000, 16, 0, 1 << 20, SafeIibAllocator::LargeZombieMode::keep, false, false },
+#endif // NODECPP_DISABLE_ZOMBIE_ACCESS_EARLY_DETECTION
+	};
+	constexpr size_t configCount = sizeof( configs ) / sizeof( configs[0] );
+
+	std::unique_ptr<ZombieBenchmarkResult[]> results( new ZombieBenchmarkResult[ configCount ]() );
+	for ( size_t i=0; i<configCount; ++i )
+	{
+		results[i].killLatency.reset();
+		MemoryFootprint mf;
+		sampleMemoryFootprint( mf );
+		results[i].rssBefore = mf.rss;
+		if ( configs[i].safe )
+		{
+			std::unique_ptr<SafeAllocatorAdapter> adapter( new SafeAllocatorAdapter( configs[i].earlyDetection, configs[i].quarantineBudget, configs[i].largeZombieMode ) );
+			runZombieBenchmark( *adapter, configs[i], results[i] );
+		}
+		else
+		{
+			std::unique_ptr<BaseAllocatorAdapter> adapter( new BaseAllocatorAdapter );
+			runZombieBenchmark( *adapter, configs[i], results[i] );
+		}
+		printZombieBenchmarkResult( configs[i], results[i], results[0] );
+	}
+
+	nodecpp::log::default_log::info( "" );
+	nodecpp::log::default_log::info( "Short summary (configuration, ops/s, relative throughput, killAllZombies() or releaseZombies() p50 ns, p99 ns, max ns, avg quarantine KB, peak quarantine KB, avg RSS growth KB):" );
+	for ( size_t i=0; i<configCount; ++i )
+	{
+		const ZombieBenchmarkResult& res = results[i];
+		double opsPerSec = res.dur ? res.opCount * 1000. / res.dur : 0;
+		double baseOpsPerSec = results[0].dur ? results[0].opCount * 1000. / results[0].dur : 0;
+		nodecpp::log::default_log::info( "{},{:.0f},{:.2f},{},{},{},{},{},{}", configs[i].name, opsPerSec, baseOpsPerSec ? opsPerSec / baseOpsPerSec : 0., 
+			(uint64_t)rdtscToNanoseconds( res.killLatency.valueAtPercentile( 50 ) ), (uint64_t)rdtscToNanoseconds( res.killLatency.valueAtPercentile( 99 ) ), (uint64_t)rdtscToNanoseconds( res.killLatency.max() ),
+			(uint64_t)res.avgQuarantineBytes() >> 10, res.peakQuarantineBytes >> 10, (uint64_t)res.avgRssGrowth() >> 10 );
+	}
+
+	nodecpp::log::default_log::info( "about to exit..." );
+	return 0;
+}
+
+#else
+
+int main()
+{
+	nodecpp::log::Log log;
+	log.level = nodecpp::log::LogLevel::info;
+	log.add( stdout );
+	nodecpp::logging_impl::currentLog = &log;
+	nodecpp::log::default_log::info( "safe allocation means are disabled (NODECPP_DISABLE_SAFE_ALLOCATION_MEANS); nothing to compare" );
+	return 0;
+}
+
+#endif // NODECPP_DISABLE_SAFE_ALLOCATION_MEANS